@@ -0,0 +1,418 @@
+#!/usr/bin/env python3
+"""
+SinoWealth 8051 Flash Dumper - Host-side throughput benchmark
+
+Measures, for every read method, the connect and detect time, the time to
+the first byte, the throughput of 4 KB, 64 KB and 128 KB reads (clamped to
+the flash size) and the latency percentiles of every RPC, against a real
+dumper or the simulated one:
+
+    python bench/throughput.py --sim -o results.json
+    python bench/throughput.py -p /dev/ttyUSB0 -o results.json
+
+With --native, the program of the native build (pio run -e native) is run
+as well: its TCK clock, JTAG shift, ICP frame and delay counts per operation
+become metrics of their own, and in --sim mode its target-side time of every
+call is added to the simulated call time, so the host measurements reflect
+the firmware in src/ too.
+
+Results are written as JSON with one flat metric per key. Given a baseline
+from an earlier run, every metric is compared within its tolerance and the
+exit status is 1 if any got worse, so regressions in src/ or scripts/ show
+up before they ship:
+
+    python bench/throughput.py --sim --native .pio/build/native/program --baseline baseline.json
+
+Copyright (C) 2024
+License: GPL-3.0
+"""
+
+import argparse
+import fnmatch
+import json
+import platform
+import re
+import statistics
+import subprocess
+import sys
+import time
+from collections.abc import Callable
+from pathlib import Path
+from typing import Any
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "scripts"))
+
+from sinowealth_dumper import ReadMethod, SinoWealthDumper  # noqa: E402
+from sinowealth_sim import (  # noqa: E402
+    METHODS_BY_NAME,
+    CallTiming,
+    SimulatedFirmware,
+    TimedInterface,
+    add_target_arguments,
+    build_target,
+)
+
+# Read methods: name -> (read method, bytes per read RPC)
+METHODS: dict[str, tuple[int, int]] = {
+    "icp16": (ReadMethod.ICP, 16),
+    "jtag16": (ReadMethod.JTAG, 16),
+    "icp1": (ReadMethod.ICP, 1),
+    "jtag1": (ReadMethod.JTAG, 1),
+}
+
+DEFAULT_RANGES: list[int] = [0x1000, 0x10000, 0x20000]
+PERCENTILES: tuple[int, ...] = (50, 90, 99)
+DEFAULT_TOLERANCES: Path = Path(__file__).resolve().parent / "tolerances.json"
+
+# Per-call counters in the report of the native build program
+NATIVE_COUNTERS: tuple[str, ...] = ("clocks", "shifts", "frames", "delay_us")
+
+# Latency tails of the simulated dumper are dominated by time.sleep jitter
+SIM_UNGATED: tuple[str, ...] = ("*.p90_ms", "*.p99_ms")
+
+
+class LatencyRecorder:
+    """Interface wrapper recording the duration of every RPC call by name."""
+
+    def __init__(self, interface: Any) -> None:
+        self._interface: Any = interface
+        self.samples: dict[str, list[float]] = {}
+
+    def __getattr__(self, name: str) -> Any:
+        attr = getattr(self._interface, name)
+        if not callable(attr) or name == "close":
+            return attr
+        samples = self.samples.setdefault(name, [])
+
+        def wrapper(*args: Any) -> Any:
+            start_time = time.perf_counter()
+            result = attr(*args)
+            samples.append(time.perf_counter() - start_time)
+            return result
+
+        return wrapper
+
+
+def run_native(program: Path) -> dict[str, list[float]]:
+    """
+    Run the native build program and parse its per-operation report.
+
+    Returns:
+        Operation -> clocks, JTAG shifts, ICP frames and delay in us per call
+    """
+    completed = subprocess.run([str(program)], capture_output=True, text=True, check=False)
+    if completed.returncode != 0 or "All checks passed" not in completed.stdout:
+        raise RuntimeError(f"{program} failed:\n{completed.stdout}{completed.stderr}")
+
+    report: dict[str, list[float]] = {}
+    for line in completed.stdout.splitlines()[1:-1]:
+        # operation name (may contain spaces), then whitespace separated numbers
+        match = re.fullmatch(r"(.+?)((?:\s+[0-9.]+)+)", line.strip())
+        if not match:
+            raise RuntimeError(f"{program}: unexpected report line {line!r}")
+        values = [float(value) for value in match.group(2).split()]
+        report[match.group(1)] = values[: len(NATIVE_COUNTERS)]
+    return report
+
+
+def native_metrics(report: dict[str, list[float]]) -> dict[str, float]:
+    """Flatten a native report into metrics, e.g. native.read16ICP.clocks."""
+    return {
+        f"native.{operation.replace(' ', '_')}.{counter}": value
+        for operation, values in report.items()
+        for counter, value in zip(NATIVE_COUNTERS, values)
+    }
+
+
+def native_target_time(report: dict[str, list[float]]) -> dict[str, float]:
+    """Target-side time in seconds of every RPC the native report covers."""
+    return {
+        operation: values[NATIVE_COUNTERS.index("delay_us")] / 1e6
+        for operation, values in report.items()
+        if operation in METHODS_BY_NAME
+    }
+
+
+def timed(function: Callable[[], Any]) -> tuple[float, Any]:
+    """Run a function and return its duration and result."""
+    start_time = time.perf_counter()
+    result = function()
+    return time.perf_counter() - start_time, result
+
+
+def read_range(dumper: SinoWealthDumper, method: int, block: int, length: int) -> int:
+    """Read a range with 16-byte or single-byte RPCs, returning the bytes read."""
+    if block == 16:
+        return len(dumper.read_flash(0, length, method))
+    read_byte = dumper.read_byte_icp if method == ReadMethod.ICP else dumper.read_byte_jtag
+    for address in range(length):
+        read_byte(address)
+    return length
+
+
+def bench_method(
+    dumper: SinoWealthDumper,
+    recorder: LatencyRecorder,
+    name: str,
+    ranges: list[int],
+    repeat: int,
+) -> dict[str, float]:
+    """Measure one read method, returning its metrics."""
+    method, block = METHODS[name]
+    metrics: dict[str, float] = {}
+    recorder.samples.clear()
+
+    dumper.disconnect()
+    metrics[f"{name}.connect_s"], connected = timed(dumper.connect)
+    if not connected:
+        raise RuntimeError("failed to connect to target device")
+    metrics[f"{name}.detect_s"], _ = timed(dumper.detect_read_method)
+
+    # First read after connect includes the mode entry
+    metrics[f"{name}.ttfb_s"], _ = timed(lambda: read_range(dumper, method, block, 1))
+
+    # Untimed warm-up so the ranges are not skewed by first-use costs on the host
+    read_range(dumper, method, block, min(ranges))
+
+    for length in ranges:
+        # Best of the repeats, like timeit: slower runs only add host noise
+        durations = [
+            timed(lambda: read_range(dumper, method, block, length))[0] for _ in range(repeat)
+        ]
+        metrics[f"{name}.bps_{length}"] = length / min(durations)
+
+    for rpc, samples in sorted(recorder.samples.items()):
+        if len(samples) < 2:
+            continue
+        cuts = statistics.quantiles(samples, n=100, method="inclusive")
+        for percentile in PERCENTILES:
+            metrics[f"{name}.rpc.{rpc}.p{percentile}_ms"] = cuts[percentile - 1] * 1000
+    return metrics
+
+
+def is_higher_better(metric: str) -> bool:
+    return ".bps_" in metric
+
+
+def seconds(metric: str, value: float) -> float | None:
+    """Value of a time metric in seconds, None for throughput metrics."""
+    if metric.endswith("_ms"):
+        return value / 1000
+    if metric.endswith("_s"):
+        return value
+    return None
+
+
+def load_tolerances(path: Path | None) -> dict[str, float]:
+    """Tolerances by metric glob pattern; the first matching pattern wins."""
+    if path is None:
+        if not DEFAULT_TOLERANCES.exists():
+            return {}
+        path = DEFAULT_TOLERANCES
+    return json.loads(path.read_text())
+
+
+def compare(
+    results: dict[str, float],
+    baseline: dict[str, float],
+    tolerance: float,
+    tolerances: dict[str, float],
+    noise_floor: float = 0.0,
+    ignore: tuple[str, ...] = (),
+) -> list[str]:
+    """
+    Compare metrics against a baseline.
+
+    Args:
+        ignore: Glob patterns of metrics left out of the comparison
+
+    Returns:
+        Descriptions of the metrics that got worse than their tolerance allows
+    """
+    regressions = []
+    for metric, base in sorted(baseline.items()):
+        if any(fnmatch.fnmatch(metric, pattern) for pattern in ignore):
+            continue
+        value = results.get(metric)
+        if value is None and metric.startswith("native."):
+            regressions.append(f"{metric}: not measured, run with --native")
+            continue
+        if value is None or base <= 0:
+            continue
+        limit = next(
+            (tol for pattern, tol in tolerances.items() if fnmatch.fnmatch(metric, pattern)),
+            tolerance,
+        )
+        change = value / base - 1
+        worse = -change if is_higher_better(metric) else change
+        # Relative changes of very short times are scheduler noise
+        delta = seconds(metric, value - base)
+        if delta is not None and delta < noise_floor:
+            continue
+        if worse > limit:
+            regressions.append(
+                f"{metric}: {value:.6g} vs baseline {base:.6g} "
+                f"({change * 100:+.1f}%, tolerance {limit * 100:.0f}%)"
+            )
+    return regressions
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description="SinoWealth 8051 Flash Dumper - Host-side throughput benchmark",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --sim -o results.json
+  %(prog)s --sim --native .pio/build/native/program --latency 0.0002 --sim-baudrate 1000000
+  %(prog)s --sim --latency 0.001 --sim-baudrate 115200 --methods icp16 jtag16 --ranges 0x1000
+  %(prog)s -p /dev/ttyUSB0 --baseline baseline.json --tolerance 0.15
+        """,
+    )
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument("-p", "--port", help="Serial port of a real dumper")
+    target.add_argument("--sim", action="store_true", help="Use the in-process simulated dumper")
+    parser.add_argument("-b", "--baudrate", type=int, default=115200, help="Serial baud rate")
+    add_target_arguments(parser)
+    parser.add_argument(
+        "--latency",
+        type=float,
+        default=0.0,
+        help="Simulated fixed delay per RPC call in seconds (default: 0)",
+    )
+    parser.add_argument(
+        "--sim-baudrate",
+        type=int,
+        default=0,
+        help="Simulated serial transfer time at this baud rate (default: 0, not modelled)",
+    )
+    parser.add_argument(
+        "--native",
+        type=Path,
+        metavar="PROGRAM",
+        help="Native build program (pio run -e native) to measure src/ with and, "
+        "with --sim, to take the target-side call times from",
+    )
+    parser.add_argument(
+        "--methods",
+        choices=list(METHODS),
+        nargs="+",
+        default=list(METHODS),
+        help="Read methods to measure: 16-byte and single-byte ICP/JTAG reads (default: all)",
+    )
+    parser.add_argument(
+        "--ranges",
+        type=lambda x: int(x, 0),
+        nargs="+",
+        default=DEFAULT_RANGES,
+        help="Read lengths in bytes, clamped to the flash size (default: 0x1000 0x10000 0x20000)",
+    )
+    parser.add_argument(
+        "--repeat",
+        type=int,
+        default=3,
+        help="Reads per range, the fastest is reported (default: 3)",
+    )
+    parser.add_argument("-o", "--output", type=Path, help="Write the results as JSON")
+    parser.add_argument("--baseline", type=Path, help="Results of an earlier run to compare with")
+    parser.add_argument(
+        "--tolerance",
+        type=float,
+        default=0.10,
+        help="Allowed relative regression of metrics without a pattern (default: 0.10)",
+    )
+    parser.add_argument(
+        "--noise-floor",
+        type=float,
+        default=0.0005,
+        help="Ignore time metrics that got slower by less than this many seconds (default: 0.0005)",
+    )
+    parser.add_argument(
+        "--tolerances",
+        type=Path,
+        help="JSON object of metric glob pattern -> tolerance (default: bench/tolerances.json)",
+    )
+    parser.add_argument(
+        "--gate-tails",
+        action="store_true",
+        help="Compare the p90/p99 RPC latencies with --sim too (default: only on a real dumper)",
+    )
+
+    args = parser.parse_args()
+
+    native: dict[str, list[float]] = {}
+    if args.native:
+        print(f"Running {args.native}...", flush=True)
+        try:
+            native = run_native(args.native)
+        except (OSError, RuntimeError) as e:
+            print(f"Error: {e}")
+            sys.exit(1)
+
+    dumper = SinoWealthDumper(args.port or "sim", args.baudrate)
+    if args.sim:
+        firmware = SimulatedFirmware(build_target(args))
+        timing = CallTiming(args.latency, args.sim_baudrate, native_target_time(native))
+        dumper.interface = TimedInterface(firmware, timing)
+    elif not dumper.open():
+        sys.exit(1)
+
+    recorder = LatencyRecorder(dumper.interface)
+    dumper.interface = recorder
+
+    try:
+        if not dumper.connect():
+            print("Error: Failed to connect to target device.")
+            sys.exit(1)
+        flash_size = dumper.get_flash_size()
+        ranges = sorted({min(length, flash_size) for length in args.ranges})
+
+        metrics: dict[str, float] = native_metrics(native)
+        for name in args.methods:
+            print(f"Measuring {name}...", flush=True)
+            metrics.update(bench_method(dumper, recorder, name, ranges, args.repeat))
+    finally:
+        dumper.disconnect()
+        dumper.close()
+
+    results = {
+        "meta": {
+            "time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            "target": "sim" if args.sim else args.port,
+            "native": str(args.native) if args.native else None,
+            "flash_size": flash_size,
+            "ranges": ranges,
+            "python": platform.python_version(),
+            "host": platform.node(),
+        },
+        "metrics": metrics,
+    }
+
+    for metric, value in metrics.items():
+        print(f"{metric:<40} {value:>14.6g}")
+
+    if args.output:
+        args.output.write_text(json.dumps(results, indent=2) + "\n")
+        print(f"Results written to {args.output}")
+
+    if args.baseline:
+        baseline = json.loads(args.baseline.read_text())["metrics"]
+        ignore = SIM_UNGATED if args.sim and not args.gate_tails else ()
+        regressions = compare(
+            metrics,
+            baseline,
+            args.tolerance,
+            load_tolerances(args.tolerances),
+            args.noise_floor,
+            ignore,
+        )
+        if regressions:
+            print(f"\n{len(regressions)} regressions against {args.baseline}:")
+            for regression in regressions:
+                print(f"  {regression}")
+            sys.exit(1)
+        print(f"\nNo regressions against {args.baseline}")
+
+
+if __name__ == "__main__":
+    main()
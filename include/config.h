@@ -1,11 +1,20 @@
 #pragma once
 
 // parameters can be retrieved from Keil C51 definition files (*.opt, *.gpt) inside UV4 folder
+// (each can also be given as a build flag, e.g. -DCHIP_FLASH_SIZE=131072)
 
+#ifndef CHIP_TYPE
 #define CHIP_TYPE			2
+#endif
+#ifndef CHIP_FLASH_SIZE
 #define CHIP_FLASH_SIZE		32768
+#endif
+#ifndef CHIP_PRODUCT_BLOCK
 #define CHIP_PRODUCT_BLOCK	1
+#endif
+#ifndef CHIP_CUSTOM_BLOCK
 #define CHIP_CUSTOM_BLOCK	3
+#endif
 
 #if CHIP_TYPE == 4
 #define CHIP_FLASH_SIZE_MAX 1048576
@@ -19,9 +28,9 @@
 #error Chip flash size is not valid for this chip type
 #endif
 
-// IO Pin Configuration for JTAG interface
-#define PIN_TDO		2	// D2
-#define PIN_TMS		3	// D3
-#define PIN_TDI		4	// D4
-#define PIN_TCK		5	// D5
-#define PIN_VREF	6	// D6
+// IO Pin Configuration for JTAG interface, as "port, bit" (any of ports B, C, D on Uno)
+#define PIN_TDO		D, 2	// D2
+#define PIN_TMS		D, 3	// D3
+#define PIN_TDI		D, 4	// D4
+#define PIN_TCK		D, 5	// D5
+#define PIN_VREF	D, 6	// D6
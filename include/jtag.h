@@ -19,10 +19,13 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "config.h"
+#include "pin.h"
 
-#define clrBit(b) (PORTD &= ~_BV(b))
-#define setBit(b) (PORTD |= _BV(b))
-#define getBit(b) (PIND & _BV(b))
+typedef PIN(PIN_TDO) PinTDO;
+typedef PIN(PIN_TMS) PinTMS;
+typedef PIN(PIN_TDI) PinTDI;
+typedef PIN(PIN_TCK) PinTCK;
+typedef PIN(PIN_VREF) PinVREF;
 
 constexpr uint8_t reverseBits(uint8_t b)
 {
@@ -36,6 +39,9 @@ public:
 
 	void connect();
 	void disconnect();
+	void release();
+
+	bool checkVREF() const;
 
 	bool checkJTAG();
 	bool checkICP();
@@ -93,7 +99,7 @@ private:
 			value >>= 1;
 		}
 
-		clrBit(PIN_TDI);
+		PinTDI::clear();
 	}
 
 	template <uint8_t N, typename T>
@@ -0,0 +1,87 @@
+/*
+   https://github.com/gashtaan/sinowealth-8051-dumper
+
+   Copyright (C) 2023, Michal Kovacik
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License version 3, as
+   published by the Free Software Foundation.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <avr/io.h>
+
+// Compile-time pin abstraction: a pin is a type made of its port and bit,
+// all operations are static and always inlined. On AVR every operation on a
+// constant pin expands to the same PORTx/PINx/DDRx expression the plain
+// register macros used to.
+//
+// A port backend provides set/clear/read/output/input on a bit mask. AVR
+// ports are defined here for every port the MCU has, hosts supply their
+// own backend in <native_port.h> with the same port names.
+
+#define PIN_INLINE inline __attribute__((always_inline))
+
+#if defined(__AVR__)
+
+#define AVR_PORT(NAME) \
+	struct Port##NAME \
+	{ \
+		static PIN_INLINE void set(uint8_t mask) { PORT##NAME |= mask; } \
+		static PIN_INLINE void clear(uint8_t mask) { PORT##NAME &= ~mask; } \
+		static PIN_INLINE uint8_t read(uint8_t mask) { return PIN##NAME & mask; } \
+		static PIN_INLINE void output(uint8_t mask) { DDR##NAME |= mask; } \
+		static PIN_INLINE void input(uint8_t mask) { DDR##NAME &= ~mask; } \
+	};
+
+#ifdef PORTA
+AVR_PORT(A)
+#endif
+#ifdef PORTB
+AVR_PORT(B)
+#endif
+#ifdef PORTC
+AVR_PORT(C)
+#endif
+#ifdef PORTD
+AVR_PORT(D)
+#endif
+#ifdef PORTE
+AVR_PORT(E)
+#endif
+#ifdef PORTF
+AVR_PORT(F)
+#endif
+
+#undef AVR_PORT
+
+#else
+
+#include <native_port.h>
+
+#endif
+
+template <class P, uint8_t Bit>
+struct Pin
+{
+	typedef P Port;
+	static constexpr uint8_t mask = 1 << Bit;
+
+	static PIN_INLINE void set() { P::set(mask); }
+	static PIN_INLINE void clear() { P::clear(mask); }
+	static PIN_INLINE bool read() { return P::read(mask); }
+	static PIN_INLINE void output() { P::output(mask); }
+	static PIN_INLINE void input() { P::input(mask); }
+};
+
+// PIN(D, 2) -> Pin<PortD, 2>, config.h defines pins as "port, bit" pairs
+#define PIN(...) PIN_TYPE(__VA_ARGS__)
+#define PIN_TYPE(port, bit) Pin<Port##port, bit>
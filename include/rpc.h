@@ -39,6 +39,17 @@ bool rpc_connect();
  */
 void rpc_disconnect();
 
+/**
+ * Put all JTAG pins to Hi-Z so the target can be removed or replaced
+ */
+void rpc_release();
+
+/**
+ * Check the VREF pin
+ * Returns true if the target is powered
+ */
+bool rpc_getVREF();
+
 /**
  * Check if ICP mode is working
  * Returns true if ICP communication is successful
@@ -97,6 +108,13 @@ unsigned char rpc_getBufferByte(unsigned char index);
  */
 unsigned char rpc_detectReadMethod();
 
+/**
+ * Compute CRC-16/CCITT-FALSE of a flash range on the dumper
+ * method: 1 for ICP, 2 for JTAG
+ * CRC is stored little endian in buffer[0..1], returns true on success
+ */
+bool rpc_crcFlash(unsigned long address, unsigned long length, unsigned char method, bool customBlock);
+
 /**
  * Get the product block address based on chip configuration
  * Returns the address or 0 if not applicable
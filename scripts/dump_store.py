@@ -0,0 +1,268 @@
+#!/usr/bin/env python3
+"""
+SinoWealth 8051 Flash Dumper - Content-addressed dump store
+
+Flash images are split into fixed-size chunks stored once under their
+SHA-256, so storage only grows with unique content. A SQLite index keeps the
+chunk list of every image and the metadata of every dump (JTAG ID, chip
+type, code options, timing), so questions like "which boards have this
+firmware" are a single indexed query.
+
+Layout:
+    <root>/index.sqlite
+    <root>/chunks/<2 hex>/<sha256>
+
+Copyright (C) 2024
+License: GPL-3.0
+"""
+
+import binascii
+import hashlib
+import re
+import sqlite3
+import threading
+import time
+from dataclasses import dataclass
+from pathlib import Path
+
+CHUNK_SIZE: int = 1024
+
+SCHEMA: str = """
+CREATE TABLE IF NOT EXISTS images (
+    sha256 TEXT PRIMARY KEY,
+    size INTEGER NOT NULL,
+    chunk_size INTEGER NOT NULL,
+    crc16 INTEGER NOT NULL
+);
+CREATE TABLE IF NOT EXISTS image_chunks (
+    image TEXT NOT NULL REFERENCES images(sha256),
+    idx INTEGER NOT NULL,
+    chunk TEXT NOT NULL,
+    PRIMARY KEY (image, idx)
+);
+CREATE TABLE IF NOT EXISTS dumps (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    image TEXT NOT NULL REFERENCES images(sha256),
+    time TEXT NOT NULL,
+    source TEXT NOT NULL,
+    jtag_id INTEGER,
+    chip_type INTEGER,
+    flash_size INTEGER,
+    start_address INTEGER NOT NULL DEFAULT 0,
+    custom_block INTEGER NOT NULL DEFAULT 0,
+    options BLOB,
+    method INTEGER,
+    elapsed REAL,
+    bytes_per_sec REAL,
+    retries INTEGER
+);
+CREATE INDEX IF NOT EXISTS dumps_image ON dumps(image);
+CREATE INDEX IF NOT EXISTS dumps_jtag_id ON dumps(jtag_id);
+"""
+
+
+@dataclass
+class DumpRecord:
+    """Metadata of one dump in the store."""
+
+    id: int
+    image: str
+    time: str
+    source: str
+    jtag_id: int | None
+    chip_type: int | None
+    flash_size: int | None
+    start_address: int
+    custom_block: bool
+    options: bytes | None
+    method: int | None
+    elapsed: float | None
+    bytes_per_sec: float | None
+    retries: int | None
+
+
+class DumpStore:
+    """Content-addressed image store with a SQLite index, safe to share between threads."""
+
+    def __init__(self, root: Path) -> None:
+        """
+        Open (or create) the store.
+
+        Args:
+            root: Store directory
+        """
+        self.root: Path = root
+        self.chunks_dir: Path = root / "chunks"
+        self.chunks_dir.mkdir(parents=True, exist_ok=True)
+        self._lock: threading.Lock = threading.Lock()
+        self._db: sqlite3.Connection = sqlite3.connect(
+            root / "index.sqlite", check_same_thread=False
+        )
+        self._db.executescript(SCHEMA)
+
+    def close(self) -> None:
+        """Close the index."""
+        self._db.close()
+
+    def scratch_path(self, name: str) -> Path:
+        """Path for a dump in progress that will be added to the store afterwards."""
+        scratch_dir = self.root / "scratch"
+        scratch_dir.mkdir(exist_ok=True)
+        return scratch_dir / f"{name}.bin"
+
+    def put(self, data: bytes) -> str:
+        """
+        Store an image, writing only chunks not stored yet.
+
+        Returns:
+            SHA-256 of the image
+        """
+        sha256 = hashlib.sha256(data).hexdigest()
+        with self._lock:
+            if self._db.execute("SELECT 1 FROM images WHERE sha256 = ?", (sha256,)).fetchone():
+                return sha256
+
+            chunks = []
+            for offset in range(0, len(data), CHUNK_SIZE):
+                chunks.append(self._put_chunk(data[offset : offset + CHUNK_SIZE]))
+
+            with self._db:
+                self._db.execute(
+                    "INSERT INTO images (sha256, size, chunk_size, crc16) VALUES (?, ?, ?, ?)",
+                    (sha256, len(data), CHUNK_SIZE, binascii.crc_hqx(data, 0xFFFF)),
+                )
+                self._db.executemany(
+                    "INSERT INTO image_chunks (image, idx, chunk) VALUES (?, ?, ?)",
+                    [(sha256, n, chunk) for n, chunk in enumerate(chunks)],
+                )
+        return sha256
+
+    def add_dump(
+        self,
+        data: bytes,
+        source: str,
+        jtag_id: int | None = None,
+        chip_type: int | None = None,
+        flash_size: int | None = None,
+        start_address: int = 0,
+        custom_block: bool = False,
+        options: bytes | None = None,
+        method: int | None = None,
+        elapsed: float | None = None,
+        retries: int | None = None,
+    ) -> tuple[int, str]:
+        """
+        Store the image of a dump and record its metadata.
+
+        Returns:
+            Dump ID and SHA-256 of the image
+        """
+        sha256 = self.put(data)
+        bytes_per_sec = len(data) / elapsed if elapsed else None
+        with self._lock, self._db:
+            cursor = self._db.execute(
+                "INSERT INTO dumps (image, time, source, jtag_id, chip_type, flash_size, "
+                "start_address, custom_block, options, method, elapsed, bytes_per_sec, retries) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                (
+                    sha256,
+                    time.strftime("%Y-%m-%dT%H:%M:%S"),
+                    source,
+                    jtag_id,
+                    chip_type,
+                    flash_size,
+                    start_address,
+                    int(custom_block),
+                    options,
+                    method,
+                    elapsed,
+                    bytes_per_sec,
+                    retries,
+                ),
+            )
+        return cursor.lastrowid or 0, sha256
+
+    def import_file(self, path: Path) -> tuple[int, str]:
+        """Import an existing flat .bin dump."""
+        data = path.read_bytes()
+        return self.add_dump(data, source=str(path), flash_size=len(data))
+
+    def resolve(self, prefix: str) -> str | None:
+        """Expand an unambiguous, non-empty SHA-256 prefix to the full image hash."""
+        prefix = prefix.lower()
+        if not re.fullmatch("[0-9a-f]+", prefix):
+            return None
+        rows = self._query(
+            "SELECT sha256 FROM images WHERE substr(sha256, 1, ?) = ? LIMIT 2",
+            (len(prefix), prefix),
+        )
+        return rows[0][0] if len(rows) == 1 else None
+
+    def get(self, sha256: str) -> bytes:
+        """Reassemble an image from its chunks and check its hash."""
+        rows = self._query(
+            "SELECT chunk FROM image_chunks WHERE image = ? ORDER BY idx", (sha256,)
+        )
+        if not rows:
+            raise KeyError(f"no image {sha256}")
+        data = b"".join(self._chunk_path(chunk).read_bytes() for (chunk,) in rows)
+        if hashlib.sha256(data).hexdigest() != sha256:
+            raise ValueError(f"image {sha256} is corrupted")
+        return data
+
+    def find_dumps(self, sha256: str | None = None, jtag_id: int | None = None) -> list[DumpRecord]:
+        """List dumps, optionally only those of one image and/or JTAG ID."""
+        conditions = []
+        params: list[object] = []
+        if sha256 is not None:
+            conditions.append("image = ?")
+            params.append(sha256)
+        if jtag_id is not None:
+            conditions.append("jtag_id = ?")
+            params.append(jtag_id)
+        where = f" WHERE {' AND '.join(conditions)}" if conditions else ""
+        rows = self._query(
+            "SELECT id, image, time, source, jtag_id, chip_type, flash_size, start_address, "
+            "custom_block, options, method, elapsed, bytes_per_sec, retries "
+            f"FROM dumps{where} ORDER BY id",
+            tuple(params),
+        )
+        # custom_block is stored as an INTEGER
+        return [DumpRecord(*row[:8], bool(row[8]), *row[9:]) for row in rows]
+
+    def stats(self) -> dict[str, int]:
+        """Number of images, dumps and unique chunks, and stored versus logical bytes."""
+        images, logical = self._query("SELECT COUNT(*), COALESCE(SUM(size), 0) FROM images")[0]
+        dumps = self._query("SELECT COUNT(*) FROM dumps")[0][0]
+        chunks = self._query("SELECT COUNT(DISTINCT chunk) FROM image_chunks")[0][0]
+        # Only count chunk files, not .tmp leftovers of an interrupted write
+        stored = sum(
+            path.stat().st_size
+            for path in self.chunks_dir.glob("*/*")
+            if re.fullmatch("[0-9a-f]{64}", path.name)
+        )
+        return {
+            "images": images,
+            "dumps": dumps,
+            "chunks": chunks,
+            "logical_bytes": logical,
+            "stored_bytes": stored,
+        }
+
+    def _query(self, sql: str, params: tuple[object, ...] = ()) -> list[tuple]:
+        with self._lock:
+            return self._db.execute(sql, params).fetchall()
+
+    def _chunk_path(self, chunk: str) -> Path:
+        return self.chunks_dir / chunk[:2] / chunk
+
+    def _put_chunk(self, data: bytes) -> str:
+        chunk = hashlib.sha256(data).hexdigest()
+        path = self._chunk_path(chunk)
+        if not path.exists():
+            path.parent.mkdir(exist_ok=True)
+            # Write under a temporary name so a crash never leaves a truncated chunk
+            temp_path = path.with_suffix(".tmp")
+            temp_path.write_bytes(data)
+            temp_path.replace(path)
+        return chunk
@@ -0,0 +1,484 @@
+#!/usr/bin/env python3
+"""
+SinoWealth 8051 Flash Dumper - Read pipeline fault injection
+
+Runs SinoWealthDumper.read_flash against the simulated firmware with faults
+injected where they happen on real fixtures, and measures what they cost:
+
+- bit flips in the data the target shifts out (JTAG::receiveICPData,
+  readFlashJTAG),
+- dropped TCK edges, after which the rest of the shift arrives one bit late,
+- serial bytes lost between host and dumper, which stall the call until
+  the simple_rpc timeout and need a port re-open.
+
+Time is virtual: every call advances a clock by its serial transfer time,
+a fixed latency and a fixed target-side time of the operation, so a sweep
+over many fault rates runs in seconds on any Linux host:
+
+    python scripts/fault_injection.py --bit-error-rate 0 1e-5 1e-4 1e-3
+
+For every fault setting and read policy the harness reports the effective
+throughput, how many faults were detected (blocks recovered by a verify
+re-read, failed reads, timeouts), how many corrupted bytes ended up in the dump undetected, and
+the retry overhead in extra bytes read.
+
+Copyright (C) 2024
+License: GPL-3.0
+"""
+
+import argparse
+import itertools
+import json
+import random
+import sys
+from dataclasses import asdict, dataclass
+from collections.abc import Callable
+from pathlib import Path
+from typing import Any
+
+from sinowealth_dumper import ReadMethod, SinoWealthDumper
+from sinowealth_sim import (
+    METHODS_BY_NAME,
+    CallTiming,
+    SimulatedFirmware,
+    SimulatedTarget,
+    add_target_arguments,
+    build_target,
+)
+
+# Target-side time of one call: fixed constants, the _delay_us time per call the
+# native build reports for the default config.h. They do not follow changes to
+# src/, re-measure with "pio run -e native -t exec" after changing the shift code.
+TARGET_TIME: dict[str, float] = {
+    "read16ICP": 1314e-6,
+    "read16JTAG": 2537e-6,
+}
+
+# Host reads are resumed in segments of this size after a failure
+SEGMENT_SIZE: int = 256
+
+
+@dataclass(frozen=True)
+class FaultModel:
+    """Fault rates of one run."""
+
+    bit_error_rate: float = 0.0  # per bit shifted out of the target
+    clock_drop_rate: float = 0.0  # per TCK edge of a shift
+    byte_loss_rate: float = 0.0  # per byte on the serial line
+
+
+class VirtualClock:
+    """Simulated time in seconds."""
+
+    def __init__(self) -> None:
+        self.now: float = 0.0
+
+    def advance(self, seconds: float) -> None:
+        self.now += seconds
+
+
+class SerialTimeout(Exception):
+    """A call whose request or response lost a byte."""
+
+
+class FaultyInterface:
+    """SimulatedFirmware interface with faults injected into shifts and the serial line."""
+
+    def __init__(
+        self,
+        firmware: SimulatedFirmware,
+        faults: FaultModel,
+        timing: CallTiming,
+        clock: VirtualClock,
+        timeout: float,
+        rng: random.Random,
+    ) -> None:
+        """
+        Args:
+            firmware: Fault-free firmware model
+            faults: Fault rates
+            timing: Serial and latency time model of a call
+            clock: Virtual clock advanced by every call
+            timeout: Time a call with a lost byte stalls before it fails
+            rng: Source of the fault positions
+        """
+        self.firmware: SimulatedFirmware = firmware
+        self.faults: FaultModel = faults
+        self.timing: CallTiming = timing
+        self.clock: VirtualClock = clock
+        self.timeout: float = timeout
+        self.rng: random.Random = rng
+        self.flipped_bits: int = 0
+        self.dropped_clocks: int = 0
+        self.lost_calls: int = 0
+
+    def close(self) -> None:
+        """Nothing to close, present for interface compatibility."""
+
+    def __getattr__(self, name: str) -> Any:
+        method = METHODS_BY_NAME[name]
+        size = method.request_size + method.response_size
+
+        def call(*args: Any) -> Any:
+            self.clock.advance(self.timing.duration(method) + TARGET_TIME.get(name, 0.0))
+            loss = self.faults.byte_loss_rate
+            if loss and self.rng.random() < 1 - (1 - loss) ** size:
+                self.lost_calls += 1
+                self.clock.advance(self.timeout)
+                raise SerialTimeout(f"{name}: serial timeout")
+
+            result = self.firmware.call(name, *args)
+            if result and name in TARGET_TIME:
+                # ICP frames are shifted LSB first, JTAG data MSB first
+                self.firmware.buffer[:16] = self._corrupt(
+                    bytes(self.firmware.buffer[:16]), lsb_first=name == "read16ICP"
+                )
+            return result
+
+        return call
+
+    def _corrupt(self, data: bytes, lsb_first: bool) -> bytes:
+        order = range(8) if lsb_first else range(7, -1, -1)
+        bits = [(byte >> n) & 1 for byte in data for n in order]
+
+        # A dropped edge repeats the bit on TDO and delays the rest of the shift
+        if self.faults.clock_drop_rate:
+            for index in range(len(bits)):
+                if self.rng.random() < self.faults.clock_drop_rate:
+                    bits = bits[: index + 1] + bits[index:-1]
+                    self.dropped_clocks += 1
+
+        if self.faults.bit_error_rate:
+            for index in range(len(bits)):
+                if self.rng.random() < self.faults.bit_error_rate:
+                    bits[index] ^= 1
+                    self.flipped_bits += 1
+
+        result = bytearray()
+        for offset in range(0, len(bits), 8):
+            result.append(sum(bit << n for bit, n in zip(bits[offset : offset + 8], order)))
+        return bytes(result)
+
+
+class QuietDumper(SinoWealthDumper):
+    """Dumper without console output, the harness reports the errors."""
+
+    def __init__(self, port: str) -> None:
+        super().__init__(port)
+        self.retried_blocks: int = 0
+
+    def log(self, message: str) -> None:
+        pass
+
+    def read_block(
+        self,
+        read_16: Callable[[int, bool], bool],
+        address: int,
+        custom_block: bool,
+        verify: bool,
+        retries: int,
+    ) -> bytes | None:
+        # Count each block a verify re-read recovered once, however many re-reads it took;
+        # a block that still fails is counted as a failed read of its segment
+        retries_before = self.read_retries
+        block = super().read_block(read_16, address, custom_block, verify, retries)
+        if block is not None and self.read_retries > retries_before:
+            self.retried_blocks += 1
+        return block
+
+
+@dataclass
+class RunResult:
+    """Outcome of one dump under one fault setting and read policy."""
+
+    bit_error_rate: float
+    clock_drop_rate: float
+    byte_loss_rate: float
+    policy: str
+    retries: int
+    length: int
+    complete: bool
+    time: float
+    bytes_read: int
+    retried_blocks: int
+    read_failures: int
+    timeouts: int
+    recoveries: int
+    corrupted_bytes: int
+    injected_bit_flips: int
+    injected_clock_drops: int
+
+    @property
+    def throughput(self) -> float:
+        """Good bytes per second of virtual time."""
+        good = self.length - self.corrupted_bytes if self.complete else 0
+        return good / self.time if self.time else 0.0
+
+    @property
+    def overhead(self) -> float:
+        """Extra bytes read over the dump length, as a fraction."""
+        return self.bytes_read / self.length - 1 if self.length else 0.0
+
+    @property
+    def detected(self) -> int:
+        """Faults caught: blocks recovered by a re-read, failed segment reads and timeouts."""
+        return self.retried_blocks + self.read_failures + self.timeouts
+
+
+def run_dump(
+    target: SimulatedTarget,
+    faults: FaultModel,
+    policy: str,
+    length: int,
+    method: int = ReadMethod.ICP,
+    retries: int = 2,
+    timing: CallTiming | None = None,
+    timeout: float = 1.0,
+    reopen_time: float = 2.0,
+    max_recoveries: int = 100,
+    seed: int = 0,
+) -> RunResult:
+    """
+    Dump the first bytes of the target through a faulty pipeline.
+
+    After a failed read or a serial timeout the dump continues from the
+    failed segment like a --resume run: a timeout costs the re-open of the
+    port (the Uno resets), both cost a reconnect of the target.
+
+    Args:
+        target: Simulated target
+        faults: Fault rates
+        policy: "none" (single read) or "verify" (read until two reads agree)
+        length: Number of bytes to dump
+        method: Read method (ICP or JTAG)
+        retries: Re-reads of a block whose verify failed
+        timing: Serial and latency model (default: 115200 baud)
+        timeout: Stall of a call that lost a byte, in seconds
+        reopen_time: Port re-open and bootloader time after a timeout, in seconds
+        max_recoveries: Give up after this many failed segments
+        seed: Seed of the fault positions
+
+    Returns:
+        Timing, counters and the number of corrupted bytes in the result
+    """
+    clock = VirtualClock()
+    interface = FaultyInterface(
+        SimulatedFirmware(target),
+        faults,
+        timing or CallTiming(0.0, 115200),
+        clock,
+        timeout,
+        random.Random(seed),
+    )
+    dumper = QuietDumper("fault-injection")
+    dumper.interface = interface
+
+    data = bytearray()
+    read_failures = 0
+    recoveries = 0
+    connected = False
+    while len(data) < length and recoveries <= max_recoveries:
+        try:
+            if not connected:
+                connected = dumper.connect()
+            address = len(data)
+            segment = dumper.read_flash(
+                address,
+                min(SEGMENT_SIZE, length - address),
+                method,
+                verify=policy == "verify",
+                retries=retries,
+            )
+            data += segment
+            if len(segment) == min(SEGMENT_SIZE, length - address):
+                continue
+            read_failures += 1
+        except SerialTimeout:
+            clock.advance(reopen_time)
+        recoveries += 1
+        connected = False
+
+    expected = bytes(target.read(address, False) for address in range(length))
+    corrupted = sum(a != b for a, b in zip(data, expected))
+    return RunResult(
+        bit_error_rate=faults.bit_error_rate,
+        clock_drop_rate=faults.clock_drop_rate,
+        byte_loss_rate=faults.byte_loss_rate,
+        policy=policy,
+        retries=retries,
+        length=length,
+        complete=len(data) >= length,
+        time=clock.now,
+        bytes_read=dumper.bytes_read,
+        retried_blocks=dumper.retried_blocks,
+        read_failures=read_failures,
+        timeouts=interface.lost_calls,
+        recoveries=recoveries,
+        corrupted_bytes=corrupted,
+        injected_bit_flips=interface.flipped_bits,
+        injected_clock_drops=interface.dropped_clocks,
+    )
+
+
+def print_results(results: list[RunResult]) -> None:
+    """Print one line per run."""
+    print(
+        f"{'BER':>8} {'Drop':>8} {'Loss':>8} {'Policy':<9} {'Time':>8} {'B/s':>8} "
+        f"{'Overhead':>8} {'Detected':>8} {'Undetect':>8} {'Recover':>7}"
+    )
+    for result in results:
+        undetected = str(result.corrupted_bytes) if result.complete else "incompl"
+        policy = f"verify/{result.retries}" if result.policy == "verify" else result.policy
+        print(
+            f"{result.bit_error_rate:>8.0e} {result.clock_drop_rate:>8.0e} "
+            f"{result.byte_loss_rate:>8.0e} {policy:<9} {result.time:>7.1f}s "
+            f"{result.throughput:>8.1f} {result.overhead * 100:>7.1f}% {result.detected:>8} "
+            f"{undetected:>8} {result.recoveries:>7}"
+        )
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description="SinoWealth 8051 Flash Dumper - Read pipeline fault injection",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --bit-error-rate 0 1e-5 1e-4 1e-3
+  %(prog)s --clock-drop-rate 1e-4 --byte-loss-rate 0 1e-5 --policy verify --retries 0 2 4
+  %(prog)s --image firmware.bin --length 0x10000 --method jtag --json results.json
+        """,
+    )
+    add_target_arguments(parser)
+    parser.add_argument(
+        "--bit-error-rate",
+        type=float,
+        nargs="+",
+        default=[0.0, 1e-5, 1e-4, 1e-3],
+        help="Probability of a flipped bit per bit shifted out of the target",
+    )
+    parser.add_argument(
+        "--clock-drop-rate",
+        type=float,
+        nargs="+",
+        default=[0.0],
+        help="Probability of a dropped TCK edge per shifted bit",
+    )
+    parser.add_argument(
+        "--byte-loss-rate",
+        type=float,
+        nargs="+",
+        default=[0.0],
+        help="Probability of a lost byte per byte on the serial line",
+    )
+    parser.add_argument(
+        "--policy",
+        choices=["none", "verify"],
+        nargs="+",
+        default=["none", "verify"],
+        help="Read policies to compare (default: both)",
+    )
+    parser.add_argument(
+        "--retries",
+        type=int,
+        nargs="+",
+        default=[2],
+        help="Re-reads of a block whose verify failed (default: 2)",
+    )
+    parser.add_argument(
+        "--length",
+        type=lambda x: int(x, 0),
+        default=4096,
+        help="Number of bytes dumped per run (default: 4096)",
+    )
+    parser.add_argument(
+        "--method",
+        choices=["icp", "jtag"],
+        default="icp",
+        help="Read method (default: icp)",
+    )
+    parser.add_argument(
+        "--baudrate",
+        type=int,
+        default=115200,
+        help="Serial baud rate to model (default: 115200)",
+    )
+    parser.add_argument(
+        "--latency",
+        type=float,
+        default=0.001,
+        help="Fixed USB-serial turnaround per call in seconds (default: 0.001)",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=1.0,
+        help="Stall of a call that lost a serial byte in seconds (default: 1)",
+    )
+    parser.add_argument(
+        "--reopen-time",
+        type=float,
+        default=2.0,
+        help="Port re-open time after a serial timeout in seconds (default: 2)",
+    )
+    parser.add_argument(
+        "--fault-seed",
+        type=int,
+        default=1,
+        help="Seed of the fault positions (default: 1)",
+    )
+    parser.add_argument(
+        "--json",
+        type=Path,
+        metavar="FILE",
+        help="Also write the results as JSON",
+    )
+
+    args = parser.parse_args()
+
+    target = build_target(args)
+    if args.length > len(target.flash):
+        print(f"Error: --length exceeds the flash size ({len(target.flash)} bytes)")
+        sys.exit(1)
+
+    method = ReadMethod.ICP if args.method == "icp" else ReadMethod.JTAG
+    timing = CallTiming(args.latency, args.baudrate)
+
+    results = []
+    for ber, drop, loss, policy, retries in itertools.product(
+        args.bit_error_rate, args.clock_drop_rate, args.byte_loss_rate, args.policy, args.retries
+    ):
+        # Retry counts only matter with verify
+        if policy == "none" and retries != args.retries[0]:
+            continue
+        results.append(
+            run_dump(
+                target,
+                FaultModel(ber, drop, loss),
+                policy,
+                args.length,
+                method=method,
+                retries=retries,
+                timing=timing,
+                timeout=args.timeout,
+                reopen_time=args.reopen_time,
+                seed=args.fault_seed,
+            )
+        )
+
+    print_results(results)
+
+    if args.json:
+        records = [
+            asdict(result)
+            | {
+                "throughput": result.throughput,
+                "overhead": result.overhead,
+                "detected": result.detected,
+            }
+            for result in results
+        ]
+        args.json.write_text(json.dumps(records, indent=2) + "\n")
+
+
+if __name__ == "__main__":
+    main()
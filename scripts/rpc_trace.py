@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+"""
+SinoWealth 8051 Flash Dumper - RPC session record and replay
+
+SinoWealthDumper records every RPC call to a compact binary trace when
+given a trace path (--record). A trace can be summarised offline, or served
+back through a pseudo-terminal like the simulated dumper, answering every
+call with the recorded result after the recorded call time, or faster:
+
+    python scripts/sinowealth_dumper.py -p /dev/ttyUSB0 -o dump.bin --record station.trace
+    python scripts/rpc_trace.py show station.trace
+    python scripts/rpc_trace.py replay station.trace --speed 10 --link /tmp/ttyREPLAY
+
+Trace layout (little endian):
+    header  "<4sBd"  magic "SWTR", version, wall-clock time the trace was created
+    record  "<QIBB"  start in ns since the header time, duration in ns,
+                     index of the method in METHODS, flags (1 = call failed)
+            followed by the arguments packed with the method's parameter
+            format and, unless the call failed, the result packed with its
+            return format
+
+Copyright (C) 2024
+License: GPL-3.0
+"""
+
+import argparse
+import statistics
+import struct
+import sys
+import time
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any, BinaryIO
+
+from sinowealth_sim import (
+    ENDIANNESS,
+    METHODS,
+    CallTiming,
+    NoResponse,
+    SimpleRPCServer,
+    serve_pty,
+    serve_tcp,
+)
+
+MAGIC: bytes = b"SWTR"
+VERSION: int = 1
+HEADER: struct.Struct = struct.Struct("<4sBd")
+RECORD: struct.Struct = struct.Struct("<QIBB")
+FLAG_ERROR: int = 0x01
+
+METHOD_INDEX: dict[str, int] = {method.name: index for index, method in enumerate(METHODS)}
+
+
+@dataclass
+class TraceRecord:
+    """One recorded RPC call."""
+
+    start: int  # ns since the trace start
+    duration: int  # ns
+    name: str
+    args: tuple[Any, ...]
+    result: Any
+    error: bool
+
+
+class TraceWriter:
+    """Appends RPC calls to a binary trace file."""
+
+    def __init__(self, path: Path) -> None:
+        self._file: BinaryIO = path.open("wb")
+        self._file.write(HEADER.pack(MAGIC, VERSION, time.time()))
+        self._origin: int = time.perf_counter_ns()
+
+    def record(
+        self,
+        name: str,
+        args: tuple[Any, ...],
+        result: Any,
+        start: int,
+        end: int,
+        error: bool = False,
+    ) -> None:
+        """
+        Record one call.
+
+        Args:
+            name: RPC method name; calls that are not RPCs are ignored
+            args: Call arguments
+            result: Returned value (ignored if the call failed)
+            start: time.perf_counter_ns() at the call
+            end: time.perf_counter_ns() at the return
+            error: The call raised an exception
+        """
+        index = METHOD_INDEX.get(name)
+        if index is None:
+            return
+        method = METHODS[index]
+        data = RECORD.pack(start - self._origin, end - start, index, FLAG_ERROR if error else 0)
+        if method.params:
+            data += struct.pack(ENDIANNESS + method.params, *args)
+        if method.ret and not error:
+            data += struct.pack(ENDIANNESS + method.ret, result)
+        self._file.write(data)
+
+    def close(self) -> None:
+        self._file.close()
+
+
+def read_trace(path: Path) -> tuple[float, list[TraceRecord]]:
+    """
+    Load a trace.
+
+    Returns:
+        Wall-clock time of the trace start and the recorded calls
+    """
+    data = path.read_bytes()
+    magic, version, start_time = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(f"{path} is not an RPC trace")
+
+    records = []
+    offset = HEADER.size
+    while offset + RECORD.size <= len(data):
+        start, duration, index, flags = RECORD.unpack_from(data, offset)
+        offset += RECORD.size
+        method = METHODS[index]
+        error = bool(flags & FLAG_ERROR)
+
+        args: tuple[Any, ...] = ()
+        if method.params:
+            args = struct.unpack_from(ENDIANNESS + method.params, data, offset)
+            offset += struct.calcsize(ENDIANNESS + method.params)
+        result = None
+        if method.ret and not error:
+            (result,) = struct.unpack_from(ENDIANNESS + method.ret, data, offset)
+            offset += struct.calcsize(ENDIANNESS + method.ret)
+
+        records.append(TraceRecord(start, duration, method.name, args, result, error))
+    return start_time, records
+
+
+class ReplayFirmware:
+    """
+    Firmware model answering calls from a recorded trace.
+
+    Calls are matched to the recording in order. If the client deviates,
+    the next matching call within a short window is used, then the last
+    recorded call with the same arguments, then a zero result; deviations
+    are counted. A call that failed in the recording is left unanswered.
+
+    Only the call durations are replayed. The host time between calls
+    (record.start) is not: the client spends its own time between calls.
+    """
+
+    WINDOW: int = 64
+
+    def __init__(self, records: list[TraceRecord], speed: float = 1.0) -> None:
+        """
+        Args:
+            records: Recorded calls
+            speed: Replay speed factor of the recorded call times, 0 to answer at once
+        """
+        self.records: list[TraceRecord] = records
+        self.speed: float = speed
+        self.position: int = 0
+        self.skipped: int = 0
+        self.mismatches: int = 0
+        self._latest: dict[tuple[str, tuple[Any, ...]], TraceRecord] = {}
+        for record in records:
+            if not record.error:
+                self._latest[(record.name, record.args)] = record
+
+    def call(self, name: str, *args: Any) -> Any:
+        record = self._match(name, args)
+        if record and self.speed:
+            time.sleep(record.duration / 1e9 / self.speed)
+        if record and record.error:
+            raise NoResponse()
+        if record:
+            return record.result
+        self.mismatches += 1
+        return 0
+
+    def _match(self, name: str, args: tuple[Any, ...]) -> TraceRecord | None:
+        end = min(self.position + self.WINDOW, len(self.records))
+        for index in range(self.position, end):
+            record = self.records[index]
+            if record.name == name and record.args == args:
+                self.skipped += index - self.position
+                self.position = index + 1
+                return record
+        return self._latest.get((name, args))
+
+
+def show_trace(path: Path) -> None:
+    """Print a per-method summary and the split of the session time."""
+    start_time, records = read_trace(path)
+    if not records:
+        print(f"{path}: no calls")
+        return
+
+    session = (records[-1].start + records[-1].duration - records[0].start) / 1e9
+    device = sum(record.duration for record in records) / 1e9
+    errors = sum(record.error for record in records)
+    print(f"Trace:            {path}")
+    print(f"Recorded:         {time.strftime('%Y-%m-%dT%H:%M:%S', time.localtime(start_time))}")
+    print(f"Calls:            {len(records)} ({errors} failed)")
+    print(f"Session time:     {session:.3f}s")
+    print(f"In RPC calls:     {device:.3f}s ({device / session * 100 if session else 0:.1f}%)")
+    print(f"Host time:        {session - device:.3f}s")
+    print()
+
+    print(f"{'Method':<24} {'Calls':>8} {'Total':>9} {'Mean':>9} {'p50':>9} {'p99':>9}")
+    by_name: dict[str, list[int]] = {}
+    for record in records:
+        by_name.setdefault(record.name, []).append(record.duration)
+    for name, durations in sorted(by_name.items(), key=lambda item: -sum(item[1])):
+        ms = sorted(duration / 1e6 for duration in durations)
+        p99 = statistics.quantiles(ms, n=100, method="inclusive")[98] if len(ms) > 1 else ms[0]
+        print(
+            f"{name:<24} {len(ms):>8} {sum(ms) / 1000:>8.3f}s {statistics.fmean(ms):>7.3f}ms "
+            f"{statistics.median(ms):>7.3f}ms {p99:>7.3f}ms"
+        )
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description="SinoWealth 8051 Flash Dumper - RPC session record and replay",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s show station.trace
+  %(prog)s replay station.trace --link /tmp/ttyREPLAY
+  %(prog)s replay station.trace --speed 0 --tcp 5555
+        """,
+    )
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    show = commands.add_parser("show", help="Summarise a trace")
+    show.add_argument("trace", type=Path)
+
+    replay = commands.add_parser("replay", help="Serve a trace like a dumper")
+    replay.add_argument("trace", type=Path)
+    replay.add_argument(
+        "--speed",
+        type=float,
+        default=1.0,
+        help="Call time factor: 1 as recorded, 10 ten times faster, 0 no delay (default: 1)",
+    )
+    replay.add_argument("--link", type=Path, help="Symlink the pseudo-terminal to this path")
+    replay.add_argument(
+        "--tcp",
+        type=int,
+        metavar="PORT",
+        help="Serve on a local TCP port instead of a pseudo-terminal",
+    )
+    replay.add_argument("-v", "--verbose", action="store_true", help="Print every RPC call")
+
+    args = parser.parse_args()
+
+    try:
+        if args.command == "show":
+            show_trace(args.trace)
+            return
+        _, records = read_trace(args.trace)
+    except (OSError, ValueError) as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    firmware = ReplayFirmware(records, args.speed)
+    server = SimpleRPCServer(firmware, CallTiming(), args.verbose)
+    print(f"Replaying {len(records)} calls at speed {args.speed:g}")
+    try:
+        if args.tcp:
+            serve_tcp(server, args.tcp)
+        else:
+            serve_pty(server, args.link)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        print(
+            f"Replayed {firmware.position} of {len(records)} calls, "
+            f"{firmware.skipped} skipped, {firmware.mismatches} unmatched"
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -12,49 +12,85 @@ License: GPL-3.0
 """
 
 import argparse
+import binascii
+import hashlib
+import json
+import os
+import queue
+import struct
 import sys
+import threading
 import time
-from collections.abc import Callable
+from collections import Counter, OrderedDict
+from collections.abc import Callable, Iterator
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import AbstractContextManager, contextmanager, nullcontext
+from dataclasses import dataclass, field
 from pathlib import Path
 from typing import Any
 
 from simple_rpc import Interface  # pyright: ignore[reportMissingTypeStubs]
 
+from dump_store import DumpStore
+
 # simple_rpc.Interface is dynamically typed - methods are generated at runtime from RPC
 # Type alias to make this explicit
 RPCInterface = Any
 
 
 class DebugRPCWrapper:
-    """Wrapper that logs all RPC calls and responses."""
+    """Wrapper that logs all RPC calls and responses and/or records them to a trace."""
 
-    def __init__(self, interface: RPCInterface) -> None:
+    def __init__(self, interface: RPCInterface, log: bool = True, trace: Any = None) -> None:
+        """
+        Args:
+            interface: RPC interface to wrap
+            log: Print every call
+            trace: rpc_trace.TraceWriter recording every call, or None
+        """
         self._interface: RPCInterface = interface
+        self._log: bool = log
+        self._trace: Any = trace
 
     def __getattr__(self, name: str) -> Any:
         attr = getattr(self._interface, name)
         if callable(attr):
+            log = self._log
+            trace = self._trace
 
             def wrapper(*args: Any, **kwargs: Any) -> Any:
-                args_str = ", ".join(
-                    [repr(a) for a in args] + [f"{k}={v!r}" for k, v in kwargs.items()]
-                )
-                print(f"[RPC] {name}({args_str})", end="", flush=True)
+                if log:
+                    args_str = ", ".join(
+                        [repr(a) for a in args] + [f"{k}={v!r}" for k, v in kwargs.items()]
+                    )
+                    print(f"[RPC] {name}({args_str})", end="", flush=True)
+                start_time = time.perf_counter_ns()
                 try:
                     result = attr(*args, **kwargs)
-                    print(f" -> {result!r}")
-                    return result
                 except Exception as e:
-                    print(f" -> ERROR: {e}")
+                    if trace:
+                        trace.record(name, args, None, start_time, time.perf_counter_ns(), True)
+                    if log:
+                        print(f" -> ERROR: {e}")
                     raise
+                if trace:
+                    trace.record(name, args, result, start_time, time.perf_counter_ns())
+                if log:
+                    print(f" -> {result!r}")
+                return result
 
+            # Cache the wrapper so __getattr__ is only hit on the first call
+            setattr(self, name, wrapper)
             return wrapper
         return attr
 
     def close(self) -> None:
-        """Pass through close method."""
+        """Pass through close method and finish the trace."""
         if hasattr(self._interface, "close"):
             self._interface.close()
+        if self._trace:
+            self._trace.close()
+            self._trace = None
 
 
 class ReadMethod:
@@ -78,11 +114,507 @@ CHIP_TYPES: dict[int, str] = {
 }
 
 
+class DumpCheckpoint:
+    """
+    Output file filled block by block, plus a sidecar bitmap of completed blocks.
+
+    The output is preallocated to the full length. Every 16-byte block of the
+    (16-byte aligned) range has one bit in the bitmap stored in
+    "<output>.map"; the sidecar is removed once all blocks are done.
+    """
+
+    BLOCK_SIZE: int = 16
+    MAGIC: bytes = b"SWCK"
+    VERSION: int = 1
+    HEADER: struct.Struct = struct.Struct("<4sBIIB")
+    FLUSH_INTERVAL: int = 64
+
+    def __init__(
+        self, output: Path, start_address: int, length: int, custom_block: bool
+    ) -> None:
+        self.output: Path = output
+        self.sidecar: Path = output.with_name(output.name + ".map")
+        self.start_address: int = start_address
+        self.length: int = length
+        self.custom_block: bool = custom_block
+        self.aligned_start: int = start_address & ~(self.BLOCK_SIZE - 1)
+        end_address = start_address + length
+        self.block_count: int = (
+            end_address - self.aligned_start + self.BLOCK_SIZE - 1
+        ) // self.BLOCK_SIZE
+        self.bitmap: bytearray = bytearray((self.block_count + 7) // 8)
+        self.done_blocks: int = 0
+        self._file: Any = None
+        self._dirty: int = 0
+
+    @classmethod
+    def open(
+        cls,
+        output: Path,
+        start_address: int,
+        length: int,
+        custom_block: bool,
+        resume: bool = False,
+    ) -> "DumpCheckpoint | None":
+        """
+        Create or resume the checkpointed output file.
+
+        Returns:
+            The checkpoint, or None if the bitmap to resume does not match the range
+        """
+        checkpoint = cls(output, start_address, length, custom_block)
+
+        if resume and checkpoint.sidecar.exists() and output.exists():
+            if not checkpoint._load_bitmap():
+                print(f"Error: {checkpoint.sidecar} was written for a different range")
+                return None
+            checkpoint._file = output.open("r+b")
+        else:
+            if resume:
+                print(f"Warning: Nothing to resume in {output}, starting from scratch")
+            checkpoint._file = output.open("w+b")
+            checkpoint._file.truncate(length)
+            checkpoint._save_bitmap()
+
+        return checkpoint
+
+    @property
+    def complete(self) -> bool:
+        """True once every block has been written."""
+        return self.done_blocks == self.block_count
+
+    def done_bytes(self) -> int:
+        """Number of bytes of the requested range already written."""
+        done = self.done_blocks * self.BLOCK_SIZE
+        if self.block_count and self.is_done(0):
+            # Bytes of the first block before the start address
+            done -= self.start_address - self.aligned_start
+        if self.block_count and self.is_done(self.block_count - 1):
+            # Bytes of the last block past the end of the range
+            end_address = self.aligned_start + self.block_count * self.BLOCK_SIZE
+            done -= end_address - (self.start_address + self.length)
+        return done
+
+    def is_done(self, index: int) -> bool:
+        """Check whether the index-th block has been written."""
+        return bool(self.bitmap[index >> 3] & (1 << (index & 7)))
+
+    def missing_blocks(self) -> Iterator[int]:
+        """Aligned addresses of all blocks not written yet, in ascending order."""
+        for index in range(self.block_count):
+            if not self.is_done(index):
+                yield self.aligned_start + index * self.BLOCK_SIZE
+
+    def first_missing_address(self) -> int:
+        """Aligned address of the first block not written yet."""
+        return next(self.missing_blocks(), self.aligned_start + self.block_count * self.BLOCK_SIZE)
+
+    def write_block(self, address: int, block: bytes) -> None:
+        """Store a block read from the aligned address and mark it as done."""
+        index = (address - self.aligned_start) // self.BLOCK_SIZE
+
+        # Clip the block to the requested range
+        first = max(address, self.start_address)
+        last = min(address + len(block), self.start_address + self.length)
+        self._file.seek(first - self.start_address)
+        self._file.write(block[first - address : last - address])
+
+        if not self.is_done(index):
+            self.bitmap[index >> 3] |= 1 << (index & 7)
+            self.done_blocks += 1
+
+        self._dirty += 1
+        if self._dirty >= self.FLUSH_INTERVAL:
+            self.flush()
+
+    def flush(self) -> None:
+        """Get written data to disk first, then the bitmap claiming it is done."""
+        if self._file:
+            self._file.flush()
+            os.fsync(self._file.fileno())
+        self._save_bitmap()
+        self._dirty = 0
+
+    def close(self) -> None:
+        """Flush and close the output, removing the sidecar if the dump is complete."""
+        if not self._file:
+            return
+        self.flush()
+        self._file.close()
+        self._file = None
+        if self.complete:
+            self.sidecar.unlink(missing_ok=True)
+
+    def _header(self) -> bytes:
+        return self.HEADER.pack(
+            self.MAGIC, self.VERSION, self.start_address, self.length, self.custom_block
+        )
+
+    def _save_bitmap(self) -> None:
+        # Replace the sidecar atomically so a crash never leaves a torn bitmap
+        temp_path = self.sidecar.with_name(self.sidecar.name + ".tmp")
+        with temp_path.open("wb") as file:
+            file.write(self._header() + self.bitmap)
+            file.flush()
+            os.fsync(file.fileno())
+        os.replace(temp_path, self.sidecar)
+
+    def _load_bitmap(self) -> bool:
+        data = self.sidecar.read_bytes()
+        header = self._header()
+        if data[: len(header)] != header or len(data) != len(header) + len(self.bitmap):
+            return False
+        self.bitmap = bytearray(data[len(header) :])
+        self.done_blocks = sum(bin(b).count("1") for b in self.bitmap)
+        return True
+
+
+class DumpMetrics:
+    """
+    Phase timings and counters of one dump, appended to a JSON Lines file.
+
+    Phases are open (serial port and simpleRPC method list), handshake (first
+    configuration RPC round trip), connect, detect (read method
+    auto-detection), read and write (output file and store). A phase that did
+    not take place during the dump, like open for the second dump on a port,
+    is null.
+    """
+
+    PHASES: tuple[str, ...] = ("open", "handshake", "connect", "detect", "read", "write")
+
+    _lock: threading.Lock = threading.Lock()
+
+    def __init__(self, bytes_read: int = 0, read_retries: int = 0) -> None:
+        """
+        Args:
+            bytes_read: Dumper byte counter at the start of the dump
+            read_retries: Dumper retry counter at the start of the dump
+        """
+        self.phases: dict[str, float | None] = dict.fromkeys(self.PHASES)
+        self.bytes_read_start: int = bytes_read
+        self.read_retries_start: int = read_retries
+
+    @contextmanager
+    def phase(self, name: str) -> Iterator[None]:
+        """Add the time spent in the with-block to a phase."""
+        start_time = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.phases[name] = (self.phases[name] or 0.0) + time.perf_counter() - start_time
+
+    def record(
+        self,
+        dumper: "SinoWealthDumper",
+        output: Path | None,
+        start_address: int,
+        length: int,
+        custom_block: bool,
+        complete: bool,
+        error: str = "",
+        data: bytes | None = None,
+        identified: bool = False,
+    ) -> dict[str, Any]:
+        """
+        Build the record of a finished (or failed) dump.
+
+        Args:
+            data: Dumped image; read back from output if not given
+            identified: The image was copied from the known firmware database, not dumped
+
+        Returns:
+            JSON-serialisable record
+        """
+        bytes_read = dumper.bytes_read - self.bytes_read_start
+        phases = dict(self.phases)
+        if identified:
+            # only the fingerprint samples were read, the image was not dumped
+            phases["read"] = phases["write"] = None
+        read_time = phases["read"]
+
+        sha256 = None
+        if complete:
+            if data is None and output:
+                data = output.read_bytes()
+            if data is not None:
+                sha256 = hashlib.sha256(data).hexdigest()
+
+        return {
+            "time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            "port": dumper.port,
+            "output": str(output) if output else None,
+            "start": start_address,
+            "length": length,
+            "custom_block": custom_block,
+            "method": {ReadMethod.ICP: "icp", ReadMethod.JTAG: "jtag"}.get(dumper.last_method),
+            "result": "identified" if identified else "ok" if complete else "failed",
+            "error": error or None,
+            "phases": {name: round(t, 6) if t is not None else None for name, t in phases.items()},
+            "bytes": length if complete else None,
+            "bytes_read": bytes_read,
+            "blocks": bytes_read // 16,
+            "retries": dumper.read_retries - self.read_retries_start,
+            "bytes_per_sec": round(bytes_read / read_time, 1) if read_time else None,
+            # the dumper firmware exposes no counters over RPC yet
+            "firmware_counters": None,
+            "sha256": sha256,
+        }
+
+    @classmethod
+    def append(cls, path: Path, record: dict[str, Any]) -> None:
+        """Append a record as one JSON line, safe to call from several threads."""
+        with cls._lock, path.open("a") as file:
+            file.write(json.dumps(record) + "\n")
+
+
+# 8051 reset and interrupt vectors
+FINGERPRINT_VECTOR_SIZE: int = 0x80
+FINGERPRINT_SAMPLE_COUNT: int = 8
+FINGERPRINT_SAMPLE_SIZE: int = 32
+
+
+def fingerprint_regions(flash_size: int) -> list[tuple[int, int]]:
+    """
+    Flash regions sampled for a fingerprint: the vector table and a few
+    blocks spread evenly over the flash.
+    """
+    regions = [(0, FINGERPRINT_VECTOR_SIZE)]
+    for n in range(1, FINGERPRINT_SAMPLE_COUNT + 1):
+        address = (flash_size * n // (FINGERPRINT_SAMPLE_COUNT + 1)) & ~0xF
+        regions.append((address, FINGERPRINT_SAMPLE_SIZE))
+    return regions
+
+
+def compute_fingerprint(flash_size: int, samples: list[bytes]) -> str:
+    """Hash the sampled regions (in fingerprint_regions order) into a fingerprint."""
+    digest = hashlib.sha256(flash_size.to_bytes(4, "little"))
+    for sample in samples:
+        digest.update(sample)
+    return digest.hexdigest()[:32]
+
+
+def fingerprint_image(image: bytes) -> str:
+    """Compute the fingerprint of a full flash image."""
+    samples = [
+        image[address : address + length]
+        for address, length in fingerprint_regions(len(image))
+    ]
+    return compute_fingerprint(len(image), samples)
+
+
+class FirmwareDatabase:
+    """
+    Local JSON database of known firmware images, keyed by fingerprint.
+
+    Every entry holds the full-image SHA-256 and CRC-16 (for an on-device
+    verify with crcFlash) and the path of the image, relative to the database.
+    """
+
+    def __init__(self, path: Path) -> None:
+        self.path: Path = path
+        self.entries: list[dict[str, Any]] = []
+        if path.exists():
+            self.entries = json.loads(path.read_text())["images"]
+
+    def add(self, name: str, image_path: Path) -> dict[str, Any]:
+        """Add (or replace) the image in the database and save it."""
+        image = image_path.read_bytes()
+        entry = {
+            "name": name,
+            "fingerprint": fingerprint_image(image),
+            "size": len(image),
+            "sha256": hashlib.sha256(image).hexdigest(),
+            "crc16": binascii.crc_hqx(image, 0xFFFF),
+            "image": os.path.relpath(image_path.resolve(), self.path.resolve().parent),
+        }
+        self.entries = [e for e in self.entries if e["sha256"] != entry["sha256"]]
+        self.entries.append(entry)
+        self.path.write_text(json.dumps({"images": self.entries}, indent=2) + "\n")
+        return entry
+
+    def lookup(self, fingerprint: str) -> dict[str, Any] | None:
+        """Find the entry matching the fingerprint."""
+        for entry in self.entries:
+            if entry["fingerprint"] == fingerprint:
+                return entry
+        return None
+
+    def image_path(self, entry: dict[str, Any]) -> Path:
+        """Resolve the image path of an entry."""
+        return self.path.resolve().parent / entry["image"]
+
+
+# Size of the product block in the custom block area, not reported by the dumper
+PRODUCT_BLOCK_SIZE: int = 64
+
+
+@dataclass
+class ImageRegion:
+    """One memory region of a full image."""
+
+    name: str
+    address: int
+    data: bytes
+    custom_block: bool = False
+
+    @property
+    def sha256(self) -> str:
+        return hashlib.sha256(self.data).hexdigest()
+
+
+class FullImage:
+    """
+    Single-file container of every memory region of a target.
+
+    Layout: header, chip metadata as JSON, region table, region data. Every
+    table entry holds the region name, address space, address, data offset,
+    length and SHA-256, so a region can be located and checked without
+    parsing the others.
+    """
+
+    MAGIC: bytes = b"SWIM"
+    VERSION: int = 1
+    HEADER: struct.Struct = struct.Struct("<4sBBI")
+    ENTRY: struct.Struct = struct.Struct("<16sBIII32s")
+    FLAG_CUSTOM_BLOCK: int = 0x01
+
+    def __init__(
+        self, regions: list[ImageRegion] | None = None, metadata: dict[str, Any] | None = None
+    ) -> None:
+        self.regions: list[ImageRegion] = regions or []
+        self.metadata: dict[str, Any] = metadata or {}
+
+    def region(self, name: str) -> ImageRegion | None:
+        """Look up a region by name."""
+        return next((region for region in self.regions if region.name == name), None)
+
+    def save(self, path: Path) -> None:
+        """Write the container."""
+        metadata = json.dumps(self.metadata, sort_keys=True).encode()
+        offset = self.HEADER.size + len(metadata) + self.ENTRY.size * len(self.regions)
+
+        table = bytearray()
+        for region in self.regions:
+            table += self.ENTRY.pack(
+                region.name.encode(),
+                self.FLAG_CUSTOM_BLOCK if region.custom_block else 0,
+                region.address,
+                offset,
+                len(region.data),
+                hashlib.sha256(region.data).digest(),
+            )
+            offset += len(region.data)
+
+        with path.open("wb") as file:
+            file.write(self.HEADER.pack(self.MAGIC, self.VERSION, len(self.regions), len(metadata)))
+            file.write(metadata)
+            file.write(table)
+            for region in self.regions:
+                file.write(region.data)
+
+    @classmethod
+    def load(cls, path: Path) -> "FullImage":
+        """Read a container, checking the hash of every region."""
+        data = path.read_bytes()
+        magic, version, count, metadata_size = cls.HEADER.unpack_from(data)
+        if magic != cls.MAGIC or version != cls.VERSION:
+            raise ValueError(f"{path} is not a full image container")
+
+        offset = cls.HEADER.size
+        metadata = json.loads(data[offset : offset + metadata_size])
+        offset += metadata_size
+
+        regions = []
+        for _ in range(count):
+            name, flags, address, data_offset, length, digest = cls.ENTRY.unpack_from(data, offset)
+            offset += cls.ENTRY.size
+            region = ImageRegion(
+                name.rstrip(b"\0").decode(),
+                address,
+                data[data_offset : data_offset + length],
+                bool(flags & cls.FLAG_CUSTOM_BLOCK),
+            )
+            if hashlib.sha256(region.data).digest() != digest:
+                raise ValueError(f"region {region.name} of {path} is corrupted")
+            regions.append(region)
+
+        return cls(regions, metadata)
+
+    def export(self, base: Path) -> list[Path]:
+        """
+        Write every region to a plain .bin file named <base stem>_<region>.bin.
+
+        Returns:
+            Paths of the written files
+        """
+        paths = []
+        for region in self.regions:
+            path = base.with_name(f"{base.stem}_{region.name}.bin")
+            path.write_bytes(region.data)
+            paths.append(path)
+        return paths
+
+
+@dataclass
+class ConsensusResult:
+    """Per-byte majority merge of several read passes."""
+
+    data: bytes
+    passes: int
+    block_reads: int
+    # address -> {value: votes} for every byte the reads disagreed on
+    contested: dict[int, dict[int, int]] = field(default_factory=dict)
+    # addresses without a strict majority or read successfully only once
+    unresolved: list[int] = field(default_factory=list)
+
+    def confidence_map(self) -> dict[str, Any]:
+        """JSON-serialisable map of the contested addresses."""
+        return {
+            "passes": self.passes,
+            "block_reads": self.block_reads,
+            "contested": [
+                {
+                    "address": address,
+                    "value": max(votes, key=votes.__getitem__),
+                    "confidence": round(max(votes.values()) / sum(votes.values()), 3),
+                    "votes": {f"0x{value:02X}": count for value, count in sorted(votes.items())},
+                }
+                for address, votes in sorted(self.contested.items())
+            ],
+            "unresolved": self.unresolved,
+        }
+
+
+def merge_block(reads: list[bytes]) -> tuple[bytes, dict[int, dict[int, int]], list[int]]:
+    """
+    Merge reads of one block by per-byte majority.
+
+    Returns:
+        Merged block, votes of the contested offsets and the offsets without a strict majority
+    """
+    merged = bytearray()
+    contested: dict[int, dict[int, int]] = {}
+    unresolved: list[int] = []
+    for offset, values in enumerate(zip(*reads)):
+        votes = Counter(values)
+        value, count = votes.most_common(1)[0]
+        merged.append(value)
+        if len(votes) > 1:
+            contested[offset] = dict(votes)
+            if count * 2 <= len(reads):
+                unresolved.append(offset)
+    return bytes(merged), contested, unresolved
+
+
 class SinoWealthDumper:
     """Interface for SinoWealth 8051 flash dumper."""
 
     def __init__(
-        self, port: str, baudrate: int = 115200, debug_rpc: bool = False
+        self,
+        port: str,
+        baudrate: int = 115200,
+        debug_rpc: bool = False,
+        record: Path | None = None,
     ) -> None:
         """
         Initialize connection to the Arduino dumper.
@@ -91,24 +623,53 @@ class SinoWealthDumper:
             port: Serial port (e.g., /dev/ttyUSB0, COM3)
             baudrate: Serial baud rate (default 115200)
             debug_rpc: Print all RPC calls and responses
+            record: Record all RPC calls to this trace file (see rpc_trace.py)
         """
         self.port: str = port
         self.baudrate: int = baudrate
         self.debug_rpc: bool = debug_rpc
+        self.record: Path | None = record
         self.interface: RPCInterface | DebugRPCWrapper | None = None
+        self.log_prefix: str = ""
+        self.read_retries: int = 0
+        self.bytes_read: int = 0
+        self.last_method: int = ReadMethod.AUTO
+        self.metrics: DumpMetrics | None = None
         self._connected: bool = False
 
+    def log(self, message: str) -> None:
+        """Print a message, each line prefixed with the port tag when several ports are in use."""
+        lines = message.split("\n")
+        print("\n".join(f"{self.log_prefix}{line}" if line else "" for line in lines))
+
+    def start_metrics(self) -> DumpMetrics:
+        """Start collecting the phase timings and counters of a new dump."""
+        self.metrics = DumpMetrics(self.bytes_read, self.read_retries)
+        return self.metrics
+
+    def phase(self, name: str) -> AbstractContextManager[None]:
+        """Time a phase of the current dump, if metrics are being collected."""
+        if self.metrics:
+            return self.metrics.phase(name)
+        return nullcontext()
+
     def open(self) -> bool:
         """Open serial connection to the Arduino."""
         try:
-            interface = Interface(self.port, self.baudrate)  # pyright: ignore[reportArgumentType]
-            if self.debug_rpc:
-                self.interface = DebugRPCWrapper(interface)
+            with self.phase("open"):
+                interface = Interface(self.port, self.baudrate)  # pyright: ignore[reportArgumentType]
+            if self.debug_rpc or self.record:
+                trace = None
+                if self.record:
+                    from rpc_trace import TraceWriter
+
+                    trace = TraceWriter(self.record)
+                self.interface = DebugRPCWrapper(interface, self.debug_rpc, trace)
             else:
                 self.interface = interface
             return True
         except Exception as e:
-            print(f"Error opening serial port: {e}")
+            self.log(f"Error opening serial port: {e}")
             return False
 
     def close(self) -> None:
@@ -129,8 +690,9 @@ class SinoWealthDumper:
         """
         if not self.interface:
             return False
-        print("Power cycle or reset the target now...")
-        result = self.interface.connect()
+        self.log("Power cycle or reset the target now...")
+        with self.phase("connect"):
+            result = self.interface.connect()
         self._connected = result
         return result
 
@@ -140,6 +702,24 @@ class SinoWealthDumper:
             self.interface.disconnect()
             self._connected = False
 
+    def release(self) -> None:
+        """Put all JTAG pins to Hi-Z so the target can be removed."""
+        if self.interface:
+            self.interface.release()
+            self._connected = False
+
+    def get_vref(self) -> bool:
+        """Check whether the target is powered (VREF high)."""
+        if not self.interface:
+            return False
+        return self.interface.getVREF()
+
+    def wait_for_removal(self, poll_interval: float = 0.1) -> None:
+        """Release the pins and block until the target is unpowered (VREF low)."""
+        self.release()
+        while self.get_vref():
+            time.sleep(poll_interval)
+
     def check_icp(self) -> bool:
         """Check if ICP mode communication is working."""
         if not self.interface:
@@ -260,6 +840,8 @@ class SinoWealthDumper:
         method: int = ReadMethod.AUTO,
         custom_block: bool = False,
         progress_callback: Callable[[int, int], None] | None = None,
+        verify: bool = False,
+        retries: int = 2,
     ) -> bytes:
         """
         Read flash memory from the target.
@@ -270,6 +852,8 @@ class SinoWealthDumper:
             method: Read method (AUTO, ICP, or JTAG)
             custom_block: Read from custom block area
             progress_callback: Optional callback(current, total) for progress
+            verify: Read every block twice, re-read until two consecutive reads agree
+            retries: Number of re-reads of a block whose verify failed
 
         Returns:
             Bytes read from flash
@@ -277,22 +861,7 @@ class SinoWealthDumper:
         if length is None:
             length = self.get_flash_size() - start_address
 
-        # Auto-detect method if needed
-        if method == ReadMethod.AUTO:
-            detected = self.detect_read_method()
-            if detected == ReadMethod.FAILED:
-                print("Warning: Auto-detection failed, trying ICP mode")
-                method = ReadMethod.ICP
-            else:
-                method = detected
-                method_name = "ICP" if method == ReadMethod.ICP else "JTAG"
-                print(f"Auto-detected read method: {method_name}")
-
-        # Select read function
-        if method == ReadMethod.ICP:
-            read_16 = self.read_16_icp
-        else:
-            read_16 = self.read_16_jtag
+        read_16 = self.select_read_16(method)
 
         # Align start address to 16-byte boundary for efficiency
         aligned_start = start_address & ~0xF
@@ -305,11 +874,13 @@ class SinoWealthDumper:
         end_address = aligned_start + aligned_length
 
         while address < end_address:
-            if not read_16(address, custom_block):
-                print(f"\nError reading at address 0x{address:06X}")
+            with self.phase("read"):
+                block = self.read_block(read_16, address, custom_block, verify, retries)
+            if block is None:
+                self.log(f"\nError reading at address 0x{address:06X}")
                 break
 
-            data.extend(self.get_buffer())
+            data.extend(block)
 
             if progress_callback:
                 progress_callback(len(data) - skip_bytes, length)
@@ -319,6 +890,1015 @@ class SinoWealthDumper:
         # Trim to requested range
         return bytes(data[skip_bytes : skip_bytes + length])
 
+    def read_flash_to_file(
+        self,
+        output: Path,
+        start_address: int = 0,
+        length: int | None = None,
+        method: int = ReadMethod.AUTO,
+        custom_block: bool = False,
+        progress_callback: Callable[[int, int], None] | None = None,
+        verify: bool = False,
+        retries: int = 2,
+        resume: bool = False,
+    ) -> bool:
+        """
+        Read flash memory straight into a preallocated output file.
+
+        Completed blocks are recorded in a sidecar bitmap next to the output
+        (see DumpCheckpoint), so an interrupted dump can be resumed after a
+        reconnect by reading only the missing blocks.
+
+        Args:
+            output: Output file
+            start_address: Starting address (default 0)
+            length: Number of bytes to read (default: full flash)
+            method: Read method (AUTO, ICP, or JTAG)
+            custom_block: Read from custom block area
+            progress_callback: Optional callback(current, total) for progress
+            verify: Read every block twice, re-read until two consecutive reads agree
+            retries: Number of re-reads of a block whose verify failed
+            resume: Continue a previous dump of the same range if its bitmap exists
+
+        Returns:
+            True if the whole range is in the output file
+        """
+        if length is None:
+            length = self.get_flash_size() - start_address
+
+        checkpoint = DumpCheckpoint.open(output, start_address, length, custom_block, resume)
+        if not checkpoint:
+            return False
+
+        try:
+            if resume and checkpoint.done_blocks:
+                self.log(
+                    f"Resuming from address 0x{checkpoint.first_missing_address():06X} "
+                    f"({checkpoint.done_bytes()} of {length} bytes already done)"
+                )
+
+            read_16 = self.select_read_16(method)
+            for address in checkpoint.missing_blocks():
+                with self.phase("read"):
+                    block = self.read_block(read_16, address, custom_block, verify, retries)
+                if block is None:
+                    self.log(f"\nError reading at address 0x{address:06X}")
+                    break
+
+                with self.phase("write"):
+                    checkpoint.write_block(address, block)
+
+                if progress_callback:
+                    progress_callback(checkpoint.done_bytes(), length)
+        finally:
+            with self.phase("write"):
+                checkpoint.close()
+
+        return checkpoint.complete
+
+    def read_full_image(
+        self,
+        method: int = ReadMethod.AUTO,
+        progress_callback: Callable[[int, int], None] | None = None,
+        verify: bool = False,
+    ) -> FullImage:
+        """
+        Read flash, custom block, code options and product block in one session.
+
+        The custom block can only be read via ICP, so all ICP reads are done
+        back to back and the JTAG ID and JTAG reads are grouped at the start
+        or end, leaving a single switch between the modes. Code options
+        and product block are cut out of the flash and custom block data
+        instead of being read again.
+
+        Args:
+            method: Read method of the main flash (AUTO, ICP, or JTAG)
+            progress_callback: Optional callback(current, total) over all regions
+            verify: Read every block twice, re-read until two consecutive reads agree
+
+        Returns:
+            The captured image; raises OSError if a region cannot be read
+        """
+        flash_size = self.get_flash_size()
+        product_block = self.get_product_block()
+        product_address = self.get_product_block_address() if product_block else 0
+        options_address = self.get_code_options_address()
+        options_size = self.get_code_options_size()
+        options_in_flash = self.get_code_options_in_flash()
+        method = self.resolve_method(method)
+
+        # Span of the custom block area holding the code options and/or the product block
+        spans = []
+        if not options_in_flash:
+            spans.append((options_address, options_address + options_size))
+        if product_block and product_address:
+            spans.append((product_address, product_address + PRODUCT_BLOCK_SIZE))
+        custom_start = min((start for start, _ in spans), default=0)
+        custom_end = max((end for _, end in spans), default=0)
+
+        # JTAG flash: JTAG ID, flash, then the ICP-only custom block.
+        # ICP flash: everything in ICP mode, the JTAG ID last.
+        reads = [("flash", 0, flash_size, False, method)]
+        if spans:
+            reads.append(
+                ("custom_block", custom_start, custom_end - custom_start, True, ReadMethod.ICP)
+            )
+        jtag_id = self.get_id() if method == ReadMethod.JTAG else 0
+        total = sum(read[2] for read in reads)
+
+        regions: dict[str, ImageRegion] = {}
+        done = 0
+        for name, address, length, custom_block, read_method in reads:
+
+            def progress(current: int, _total: int, base: int = done) -> None:
+                if progress_callback:
+                    progress_callback(base + current, total)
+
+            data = self.read_flash(address, length, read_method, custom_block, progress, verify)
+            if len(data) != length:
+                raise OSError(f"only read {len(data)} of {length} bytes of the {name}")
+            regions[name] = ImageRegion(name, address, data, custom_block)
+            done += length
+
+        if method != ReadMethod.JTAG:
+            jtag_id = self.get_id()
+
+        def cut(address: int, length: int, custom_block: bool) -> bytes:
+            source = regions["custom_block" if custom_block else "flash"]
+            return source.data[address - source.address : address - source.address + length]
+
+        ordered = [regions["flash"]]
+        if "custom_block" in regions:
+            ordered.append(regions["custom_block"])
+        ordered.append(
+            ImageRegion(
+                "code_options",
+                options_address,
+                cut(options_address, options_size, not options_in_flash),
+                not options_in_flash,
+            )
+        )
+        if product_block and product_address:
+            ordered.append(
+                ImageRegion(
+                    "product_block",
+                    product_address,
+                    cut(product_address, PRODUCT_BLOCK_SIZE, True),
+                    True,
+                )
+            )
+
+        metadata = {
+            "time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            "source": self.port,
+            "jtag_id": jtag_id,
+            "chip_type": self.get_chip_type(),
+            "flash_size": flash_size,
+            "product_block": product_block,
+            "custom_block_type": self.get_custom_block(),
+            "code_options_in_flash": options_in_flash,
+            "method": "icp" if method == ReadMethod.ICP else "jtag",
+        }
+        return FullImage(ordered, metadata)
+
+    def read_consensus(
+        self,
+        start_address: int,
+        length: int,
+        method: int = ReadMethod.AUTO,
+        custom_block: bool = False,
+        passes: int = 3,
+        progress_callback: Callable[[int, int], None] | None = None,
+    ) -> ConsensusResult:
+        """
+        Read a range in several passes with a power cycle in between and merge them.
+
+        The first two passes read the whole range. Later passes only re-read
+        the blocks that do not have two agreeing reads for every byte yet,
+        so a clean target costs two reads and a bad fixture only pays extra
+        for its contested blocks. A block read that fails is dropped from
+        its pass. Between passes the pins are released and the operator
+        power cycles the target (VREF goes low, then high again), which
+        often clears the condition.
+
+        Args:
+            start_address: Starting address
+            length: Number of bytes to read
+            method: Read method (AUTO, ICP, or JTAG)
+            custom_block: Read from custom block area
+            passes: Maximum number of passes
+            progress_callback: Optional callback(current, total) within each pass
+
+        Returns:
+            The merged data and the votes of every contested address
+        """
+        read_16 = self.select_read_16(method)
+        aligned_start = start_address & ~0xF
+        end_address = (start_address + length + 15) & ~0xF
+        reads: dict[int, list[bytes]] = {
+            address: [] for address in range(aligned_start, end_address, 16)
+        }
+
+        def settled(address: int) -> bool:
+            # A single read is not a majority, at least two must agree
+            return len(reads[address]) >= 2 and not merge_block(reads[address])[2]
+
+        passes_done = 0
+        block_reads = 0
+        for n in range(passes):
+            pending = [address for address in reads if n < 2 or not settled(address)]
+            if not pending:
+                break
+
+            if n > 0:
+                self.log(
+                    f"\nPass {n + 1}/{passes}: {len(pending)} blocks, "
+                    "remove power from the target..."
+                )
+                self.disconnect()
+                self.wait_for_removal()
+                if not self.connect():
+                    raise OSError("failed to reconnect to target device")
+                jtag_id = self.get_id()
+                if jtag_id in (0x0000, 0xFFFF):
+                    raise OSError(f"invalid JTAG ID 0x{jtag_id:04X} after reconnect")
+                read_16 = self.select_read_16(self.last_method)
+
+            for index, address in enumerate(pending):
+                with self.phase("read"):
+                    block = self.read_block(read_16, address, custom_block, False, 0)
+                if block is not None:
+                    reads[address].append(block)
+                    block_reads += 1
+                if progress_callback:
+                    progress_callback((index + 1) * 16, len(pending) * 16)
+            passes_done += 1
+
+        missing = [address for address, block_list in reads.items() if not block_list]
+        if missing:
+            raise OSError(f"no successful read of block 0x{missing[0]:06X}")
+
+        data = bytearray()
+        result = ConsensusResult(b"", passes_done, block_reads)
+        for address, block_list in reads.items():
+            block, contested, unresolved = merge_block(block_list)
+            data += block
+            for offset, votes in contested.items():
+                result.contested[address + offset] = votes
+            if len(block_list) < 2:
+                unresolved = list(range(16))
+            result.unresolved += [address + offset for offset in unresolved]
+
+        # Trim to the requested range
+        skip = start_address - aligned_start
+        result.data = bytes(data[skip : skip + length])
+        result.contested = {
+            address: votes
+            for address, votes in result.contested.items()
+            if start_address <= address < start_address + length
+        }
+        end_address = start_address + length
+        result.unresolved = [
+            address for address in result.unresolved if start_address <= address < end_address
+        ]
+        return result
+
+    def crc_flash(
+        self,
+        address: int,
+        length: int,
+        method: int = ReadMethod.AUTO,
+        custom_block: bool = False,
+    ) -> int | None:
+        """
+        Compute CRC-16/CCITT-FALSE of a flash range on the dumper.
+
+        The result matches binascii.crc_hqx(data, 0xFFFF) of the same range,
+        only two bytes travel over the serial line.
+
+        Returns:
+            CRC, or None if the dumper failed to read the range
+        """
+        if not self.interface:
+            return None
+        method = self.resolve_method(method)
+        if not self.interface.crcFlash(address, length, method, custom_block):
+            return None
+        return self.interface.getBufferByte(0) | self.interface.getBufferByte(1) << 8
+
+    def read_fingerprint(self, method: int = ReadMethod.AUTO) -> tuple[str, bytes]:
+        """
+        Read the sampled fingerprint regions of the flash.
+
+        Returns:
+            Fingerprint (see fingerprint_image) and the code options bytes,
+            which are reported only and not part of the fingerprint
+        """
+        method = self.resolve_method(method)
+        flash_size = self.get_flash_size()
+
+        samples = [
+            self.read_flash(address, length, method)
+            for address, length in fingerprint_regions(flash_size)
+        ]
+        return compute_fingerprint(flash_size, samples), self.read_code_options(method)
+
+    def read_code_options(self, method: int = ReadMethod.AUTO) -> bytes:
+        """
+        Read the code options, from flash or (via ICP) from the custom block.
+
+        The options are metadata of the target, so they are not counted in
+        bytes_read like the flash contents of a dump.
+        """
+        if self.get_code_options_in_flash():
+            method = self.resolve_method(method)
+            custom_block = False
+        else:
+            method = ReadMethod.ICP
+            custom_block = True
+        bytes_read = self.bytes_read
+        options = self.read_flash(
+            self.get_code_options_address(),
+            self.get_code_options_size(),
+            method,
+            custom_block=custom_block,
+        )
+        self.bytes_read = bytes_read
+        return options
+
+    def resolve_method(self, method: int) -> int:
+        """Resolve AUTO to the detected read method (ICP if detection fails)."""
+        if method == ReadMethod.AUTO:
+            with self.phase("detect"):
+                detected = self.detect_read_method()
+            if detected == ReadMethod.FAILED:
+                self.log("Warning: Auto-detection failed, trying ICP mode")
+                method = ReadMethod.ICP
+            else:
+                method = detected
+                method_name = "ICP" if method == ReadMethod.ICP else "JTAG"
+                self.log(f"Auto-detected read method: {method_name}")
+        self.last_method = method
+        return method
+
+    def select_read_16(self, method: int) -> Callable[[int, bool], bool]:
+        """Resolve the read method (auto-detecting it if needed) to a 16-byte read function."""
+        if self.resolve_method(method) == ReadMethod.ICP:
+            return self.read_16_icp
+        return self.read_16_jtag
+
+    def read_block(
+        self,
+        read_16: Callable[[int, bool], bool],
+        address: int,
+        custom_block: bool,
+        verify: bool,
+        retries: int,
+    ) -> bytes | None:
+        """Read one 16-byte block, with verify until two consecutive reads agree."""
+        if not read_16(address, custom_block):
+            return None
+        block = self.get_buffer()
+        self.bytes_read += len(block)
+        if not verify:
+            return block
+
+        for _ in range(retries + 1):
+            if not read_16(address, custom_block):
+                return None
+            again = self.get_buffer()
+            self.bytes_read += len(again)
+            if again == block:
+                return block
+            self.read_retries += 1
+            block = again
+
+        self.log(f"\nVerify failed at address 0x{address:06X}")
+        return None
+
+
+class TargetFlash:
+    """
+    Read-only view of the target flash that can be indexed like bytes.
+
+    Nothing is read up front: aligned pages are fetched on first access with
+    the 16-byte read RPCs and kept in an LRU cache, and when accesses stream
+    through consecutive pages the following pages are fetched ahead. A
+    disassembler or signature scanner only pays for what it touches.
+
+        flash = TargetFlash(dumper)
+        vectors = flash[0:0x80]
+        offset = flash.find(b"\\x02\\x00\\x80")
+
+    It is not a buffer; bytes(flash) reads the whole view into a bytes copy.
+    """
+
+    PAGE_SIZE: int = 256
+
+    def __init__(
+        self,
+        dumper: SinoWealthDumper,
+        method: int = ReadMethod.AUTO,
+        custom_block: bool = False,
+        size: int | None = None,
+        cache_pages: int = 64,
+        prefetch_pages: int = 4,
+    ) -> None:
+        """
+        Args:
+            dumper: Connected dumper
+            method: Read method (AUTO is resolved once)
+            custom_block: View the custom block instead of the main flash
+            size: Size of the view (default: flash size)
+            cache_pages: Number of pages kept in the cache
+            prefetch_pages: Pages read ahead once two consecutive pages were accessed
+        """
+        self.dumper: SinoWealthDumper = dumper
+        self.custom_block: bool = custom_block
+        self.size: int = size if size is not None else dumper.get_flash_size()
+        self.cache_pages: int = max(cache_pages, prefetch_pages + 1)
+        self.prefetch_pages: int = prefetch_pages
+        self.hits: int = 0
+        self.misses: int = 0
+        self._read_16: Callable[[int, bool], bool] = dumper.select_read_16(method)
+        self._pages: OrderedDict[int, bytes] = OrderedDict()
+        self._last_page: int = -2
+
+    def __len__(self) -> int:
+        return self.size
+
+    def __getitem__(self, key: int | slice) -> Any:
+        if isinstance(key, slice):
+            start, stop, step = key.indices(self.size)
+            if step != 1:
+                return bytes(self[i] for i in range(start, stop, step))
+            return self._read(start, max(stop - start, 0))
+
+        if key < 0:
+            key += self.size
+        if not 0 <= key < self.size:
+            raise IndexError("flash index out of range")
+        return self._page(key // self.PAGE_SIZE)[key % self.PAGE_SIZE]
+
+    def __iter__(self) -> Iterator[int]:
+        for page in range(0, self.size, self.PAGE_SIZE):
+            yield from self._read(page, min(self.PAGE_SIZE, self.size - page))
+
+    def __contains__(self, item: int | bytes) -> bool:
+        if isinstance(item, int):
+            item = bytes([item])
+        return self.find(item) >= 0
+
+    def __bytes__(self) -> bytes:
+        return self._read(0, self.size)
+
+    def find(self, sub: bytes, start: int = 0, end: int | None = None) -> int:
+        """Lowest address of sub in [start, end), or -1; reads page by page."""
+        start, end, _ = slice(start, end).indices(self.size)
+        if not sub:
+            return start if start <= end else -1
+
+        # Search page-sized windows overlapping by len(sub) - 1 so matches across pages are found
+        address = start
+        while address < end:
+            window_end = min(address - address % self.PAGE_SIZE + self.PAGE_SIZE, end)
+            window = self._read(address, min(window_end + len(sub) - 1, end) - address)
+            offset = window.find(sub)
+            if offset >= 0:
+                return address + offset
+            address = window_end
+        return -1
+
+    def _read(self, address: int, length: int) -> bytes:
+        data = bytearray()
+        while length > 0:
+            page, offset = divmod(address, self.PAGE_SIZE)
+            chunk = self._page(page)[offset : offset + length]
+            data += chunk
+            address += len(chunk)
+            length -= len(chunk)
+        return bytes(data)
+
+    def _page(self, page: int) -> bytes:
+        data = self._pages.get(page)
+        if data is not None:
+            self.hits += 1
+            self._pages.move_to_end(page)
+        else:
+            self.misses += 1
+            data = self._fetch(page)
+
+        # Streaming access, read the next pages while we are at it
+        if page == self._last_page + 1:
+            for ahead in range(page + 1, page + 1 + self.prefetch_pages):
+                if ahead * self.PAGE_SIZE >= self.size or ahead in self._pages:
+                    continue
+                self._fetch(ahead)
+        self._last_page = page
+        return data
+
+    def _fetch(self, page: int) -> bytes:
+        start = page * self.PAGE_SIZE
+        end = min(start + self.PAGE_SIZE, self.size)
+        data = bytearray()
+        for address in range(start, end, 16):
+            block = self.dumper.read_block(self._read_16, address, self.custom_block, False, 0)
+            if block is None:
+                raise OSError(f"error reading flash at address 0x{address:06X}")
+            data += block
+        page_data = bytes(data[: end - start])
+
+        self._pages[page] = page_data
+        while len(self._pages) > self.cache_pages:
+            self._pages.popitem(last=False)
+        return page_data
+
+
+@dataclass
+class DumpJob:
+    """A single flash dump scheduled on whichever port becomes free first."""
+
+    output: Path
+    start_address: int = 0
+    length: int | None = None
+    method: int = ReadMethod.AUTO
+    custom_block: bool = False
+    resume: bool = False
+
+
+@dataclass
+class PortStats:
+    """Progress, throughput and error counters of one dumper port."""
+
+    port: str
+    jobs_done: int = 0
+    jobs_failed: int = 0
+    bytes_read: int = 0
+    busy_time: float = 0.0
+    current: int = 0
+    total: int = 0
+    state: str = "idle"
+    # The port could not be opened or was retired after repeated failures
+    dead: bool = False
+    errors: list[str] = field(default_factory=list)
+
+    @property
+    def throughput(self) -> float:
+        """Bytes per second while the port was busy dumping."""
+        return self.bytes_read / self.busy_time if self.busy_time > 0 else 0.0
+
+
+def job_output_path(base: Path, index: int) -> Path:
+    """Derive the output file of the index-th job from the base output path."""
+    return base.with_name(f"{base.stem}_{index:03d}{base.suffix}")
+
+
+def port_trace_path(base: Path | None, port: str, ports: list[str]) -> Path | None:
+    """Derive the RPC trace file of a port when several ports record at once."""
+    if base is None or len(ports) == 1:
+        return base
+    return base.with_name(f"{base.stem}_{Path(port).name}{base.suffix}")
+
+
+class DumpOrchestrator:
+    """
+    Runs dumps on several serial ports concurrently.
+
+    Every port gets its own worker thread and its own SinoWealthDumper, so the
+    ports never wait on each other and station throughput scales with the
+    number of dumpers. Jobs are taken from a shared queue by whichever port
+    is free first. A port whose jobs keep failing is retired so it does not
+    drain the queue; a dead port fails the run like a failed job.
+    """
+
+    MAX_CONSECUTIVE_FAILURES: int = 3
+
+    def __init__(
+        self,
+        ports: list[str],
+        baudrate: int = 115200,
+        debug_rpc: bool = False,
+        store: DumpStore | None = None,
+        metrics_file: Path | None = None,
+        record: Path | None = None,
+    ) -> None:
+        """
+        Args:
+            ports: Serial ports, one per dumper
+            baudrate: Serial baud rate used for every port
+            debug_rpc: Print all RPC calls and responses
+            store: Optional dump store every finished dump is added to
+            metrics_file: Optional JSON Lines file a record of every dump is appended to
+            record: Optional RPC trace file, one per port named after the port
+        """
+        self.ports: list[str] = ports
+        self.baudrate: int = baudrate
+        self.debug_rpc: bool = debug_rpc
+        self.store: DumpStore | None = store
+        self.metrics_file: Path | None = metrics_file
+        self.record: Path | None = record
+        self.stats: dict[str, PortStats] = {port: PortStats(port) for port in ports}
+        self.wall_time: float = 0.0
+        self._jobs: queue.Queue[DumpJob] = queue.Queue()
+        self._done: threading.Event = threading.Event()
+
+    def run(self, jobs: list[DumpJob], show_progress: bool = True) -> bool:
+        """
+        Execute all jobs across the ports and wait for them to finish.
+
+        Args:
+            jobs: Dumps to perform
+            show_progress: Periodically print a status line of all ports
+
+        Returns:
+            True if every job succeeded and no port is dead
+        """
+        for job in jobs:
+            self._jobs.put(job)
+
+        self._done.clear()
+        reporter = None
+        if show_progress:
+            reporter = threading.Thread(target=self._report_progress, daemon=True)
+            reporter.start()
+
+        start_time = time.time()
+        with ThreadPoolExecutor(max_workers=len(self.ports)) as pool:
+            for port in self.ports:
+                pool.submit(self._worker, port)
+        self.wall_time = time.time() - start_time
+
+        self._done.set()
+        if reporter:
+            reporter.join()
+            print()
+
+        # Jobs left over when all ports failed to open
+        success = True
+        while not self._jobs.empty():
+            job = self._jobs.get_nowait()
+            print(f"Error: No working port left for {job.output}")
+            success = False
+
+        return success and all(
+            stats.jobs_failed == 0 and not stats.dead for stats in self.stats.values()
+        )
+
+    def _worker(self, port: str) -> None:
+        stats = self.stats[port]
+        dumper = SinoWealthDumper(
+            port,
+            self.baudrate,
+            debug_rpc=self.debug_rpc,
+            record=port_trace_path(self.record, port, self.ports),
+        )
+        dumper.log_prefix = f"[{port}] "
+        if self.metrics_file:
+            dumper.start_metrics()
+
+        stats.state = "opening"
+        if not dumper.open():
+            stats.state = "dead"
+            stats.dead = True
+            stats.errors.append("cannot open serial port")
+            return
+
+        failures = 0
+        try:
+            while True:
+                try:
+                    job = self._jobs.get_nowait()
+                except queue.Empty:
+                    break
+                failures = 0 if self._run_job(dumper, stats, job) else failures + 1
+                if failures >= self.MAX_CONSECUTIVE_FAILURES:
+                    stats.dead = True
+                    stats.errors.append(f"retired after {failures} consecutive failures")
+                    dumper.log(f"Error: Retiring port after {failures} consecutive failures")
+                    break
+        finally:
+            stats.state = "dead" if stats.dead else "idle"
+            dumper.close()
+
+    def _run_job(self, dumper: SinoWealthDumper, stats: PortStats, job: DumpJob) -> bool:
+        """Run one job on an opened port, returning True if it succeeded."""
+
+        def progress(current: int, total: int) -> None:
+            stats.current = current
+            stats.total = total
+
+        start_time = time.time()
+        length = job.length or 0
+        complete = False
+        error = ""
+        try:
+            stats.state = "connect"
+            if not dumper.connect():
+                raise RuntimeError("failed to connect to target device")
+
+            if job.length is None:
+                with dumper.phase("handshake"):
+                    length = dumper.get_flash_size() - job.start_address
+            options = dumper.read_code_options(job.method) if self.store else None
+
+            stats.state = "read"
+            stats.current = 0
+            stats.total = length
+            bytes_before = dumper.bytes_read
+            retries_before = dumper.read_retries
+            complete = dumper.read_flash_to_file(
+                job.output,
+                start_address=job.start_address,
+                length=length,
+                method=job.method,
+                custom_block=job.custom_block,
+                progress_callback=progress,
+                resume=job.resume,
+            )
+            stats.bytes_read += dumper.bytes_read - bytes_before
+
+            if not complete:
+                raise RuntimeError("incomplete dump, resume it with --resume")
+
+            if self.store:
+                with dumper.phase("write"):
+                    store_dump(
+                        self.store,
+                        dumper,
+                        job.output.read_bytes(),
+                        job.start_address,
+                        job.custom_block,
+                        time.time() - start_time,
+                        options,
+                        dumper.read_retries - retries_before,
+                    )
+
+            stats.jobs_done += 1
+            dumper.log(f"Saved {length} bytes to {job.output}")
+        except Exception as e:
+            error = str(e)
+            stats.jobs_failed += 1
+            stats.errors.append(f"{job.output}: {e}")
+            dumper.log(f"Error: {job.output}: {e}")
+        finally:
+            stats.busy_time += time.time() - start_time
+            if self.metrics_file and dumper.metrics:
+                DumpMetrics.append(
+                    self.metrics_file,
+                    dumper.metrics.record(
+                        dumper, job.output, job.start_address, length, job.custom_block,
+                        complete and not error, error,
+                    ),
+                )
+                dumper.start_metrics()
+            try:
+                dumper.disconnect()
+            except Exception:
+                pass
+        return complete and not error
+
+    def _report_progress(self) -> None:
+        while not self._done.wait(0.5):
+            parts = []
+            for stats in self.stats.values():
+                name = Path(stats.port).name
+                if stats.state == "read" and stats.total > 0:
+                    parts.append(f"{name} {stats.current * 100 // stats.total:3d}%")
+                else:
+                    parts.append(f"{name} {stats.state}")
+            print("\r" + " | ".join(parts), end="", flush=True)
+
+    def print_summary(self) -> None:
+        """Print per-port statistics and the aggregated station figures."""
+        print("\n=== Station Summary ===")
+        print(
+            f"{'Port':<20} {'OK':>4} {'Fail':>4} {'Bytes':>10} {'Busy':>8} {'B/s':>9} {'State':>6}"
+        )
+        for stats in self.stats.values():
+            print(
+                f"{stats.port:<20} {stats.jobs_done:>4} {stats.jobs_failed:>4} "
+                f"{stats.bytes_read:>10} {stats.busy_time:>7.1f}s {stats.throughput:>9.1f} "
+                f"{'dead' if stats.dead else 'ok':>6}"
+            )
+
+        total_bytes = sum(stats.bytes_read for stats in self.stats.values())
+        jobs_done = sum(stats.jobs_done for stats in self.stats.values())
+        jobs_failed = sum(stats.jobs_failed for stats in self.stats.values())
+        dead_ports = sum(stats.dead for stats in self.stats.values())
+        speed = total_bytes / self.wall_time if self.wall_time > 0 else 0
+        print(
+            f"Total:            {jobs_done} OK, {jobs_failed} failed, {dead_ports} dead ports, "
+            f"{total_bytes} bytes"
+        )
+        print(f"Wall time:        {self.wall_time:.1f}s")
+        print(f"Station speed:    {speed:.1f} bytes/sec")
+
+        for stats in self.stats.values():
+            for error in stats.errors:
+                print(f"Error [{stats.port}]: {error}")
+
+
+@dataclass
+class StationCycle:
+    """Outcome and phase timings of one board handled in station mode."""
+
+    board: int
+    jtag_id: int = 0
+    passed: bool = False
+    error: str = ""
+    output: Path | None = None
+    connect_time: float = 0.0
+    identify_time: float = 0.0
+    read_time: float = 0.0
+    write_time: float = 0.0
+    removal_time: float = 0.0
+
+    @property
+    def cycle_time(self) -> float:
+        """Time from the board being connected until its result is signalled."""
+        return self.identify_time + self.read_time + self.write_time
+
+
+class ProductionStation:
+    """
+    Continuous detect-dump-verify loop on one dumper port.
+
+    The serial port stays open for the whole run. A new board is detected by
+    its VREF edge (JTAG::connect waits for it), dumped with per-block verify,
+    written out and signalled, then the pins are released and the station
+    waits for VREF to drop before it waits for the next board.
+    """
+
+    LOG_HEADER: str = (
+        "time,port,board,jtag_id,result,connect,identify,read,write,cycle,removal,output,error"
+    )
+
+    _log_lock: threading.Lock = threading.Lock()
+
+    def __init__(
+        self,
+        dumper: SinoWealthDumper,
+        output: Path,
+        method: int = ReadMethod.AUTO,
+        start_address: int = 0,
+        length: int | None = None,
+        log_file: Path | None = None,
+        store: DumpStore | None = None,
+        metrics_file: Path | None = None,
+    ) -> None:
+        """
+        Args:
+            dumper: Opened dumper, kept open across all boards
+            output: Base output path, board number and JTAG ID are appended
+            method: Read method (AUTO, ICP, or JTAG)
+            start_address: Starting address of each dump
+            length: Number of bytes of each dump (default: full flash)
+            log_file: Optional CSV file the per-board timings are appended to
+            store: Optional dump store every passed board is added to
+            metrics_file: Optional JSON Lines file a record of every board is appended to
+        """
+        self.dumper: SinoWealthDumper = dumper
+        self.output: Path = output
+        self.method: int = method
+        self.start_address: int = start_address
+        self.length: int | None = length
+        self.log_file: Path | None = log_file
+        self.store: DumpStore | None = store
+        self.metrics_file: Path | None = metrics_file
+        self.passed: int = 0
+        self.failed: int = 0
+
+    def run(self, max_boards: int | None = None) -> None:
+        """Handle boards until max_boards have been processed (forever if None)."""
+        board = 0
+        while max_boards is None or board < max_boards:
+            board += 1
+            self.dumper.log(f"Waiting for board {board}...")
+            cycle = self.cycle(board)
+            if cycle.passed:
+                self.passed += 1
+            else:
+                self.failed += 1
+            self._signal(cycle)
+
+            start_time = time.time()
+            self.dumper.wait_for_removal()
+            cycle.removal_time = time.time() - start_time
+            self._write_log(cycle)
+
+    def cycle(self, board: int) -> StationCycle:
+        """Connect, identify, dump, verify and write a single board."""
+        cycle = StationCycle(board)
+        if self.metrics_file and not self.dumper.metrics:
+            self.dumper.start_metrics()
+        length = self.length or 0
+        data = None
+        phase_start = time.time()
+        try:
+            if not self.dumper.connect():
+                raise RuntimeError("failed to connect to target device")
+            cycle.connect_time = time.time() - phase_start
+
+            phase_start = time.time()
+            cycle.jtag_id = self.dumper.get_id()
+            if cycle.jtag_id in (0x0000, 0xFFFF):
+                raise RuntimeError(f"invalid JTAG ID 0x{cycle.jtag_id:04X}")
+            if self.length is None:
+                with self.dumper.phase("handshake"):
+                    length = self.dumper.get_flash_size() - self.start_address
+            options = self.dumper.read_code_options(self.method) if self.store else None
+            cycle.identify_time = time.time() - phase_start
+
+            phase_start = time.time()
+            retries_before = self.dumper.read_retries
+            data = self.dumper.read_flash(
+                start_address=self.start_address,
+                length=length,
+                method=self.method,
+                verify=True,
+            )
+            cycle.read_time = time.time() - phase_start
+            if len(data) != length:
+                raise RuntimeError(f"only read {len(data)} of {length} bytes")
+
+            phase_start = time.time()
+            port_name = Path(self.dumper.port).name
+            cycle.output = self.output.with_name(
+                f"{self.output.stem}_{port_name}_{board:04d}_{cycle.jtag_id:04X}"
+                f"{self.output.suffix}"
+            )
+            with self.dumper.phase("write"):
+                cycle.output.write_bytes(data)
+                if self.store:
+                    store_dump(
+                        self.store,
+                        self.dumper,
+                        data,
+                        self.start_address,
+                        False,
+                        cycle.read_time,
+                        options,
+                        self.dumper.read_retries - retries_before,
+                        jtag_id=cycle.jtag_id,
+                    )
+            cycle.write_time = time.time() - phase_start
+
+            cycle.passed = True
+        except Exception as e:
+            cycle.error = str(e)
+        finally:
+            try:
+                self.dumper.disconnect()
+            except Exception:
+                pass
+            if self.metrics_file and self.dumper.metrics:
+                DumpMetrics.append(
+                    self.metrics_file,
+                    self.dumper.metrics.record(
+                        self.dumper, cycle.output, self.start_address, length, False,
+                        cycle.passed, cycle.error, data,
+                    ),
+                )
+                self.dumper.metrics = None
+        return cycle
+
+    def _signal(self, cycle: StationCycle) -> None:
+        if cycle.passed:
+            self.dumper.log(
+                f"\a*** PASS *** board {cycle.board} (ID 0x{cycle.jtag_id:04X}) "
+                f"-> {cycle.output}, cycle {cycle.cycle_time:.2f}s "
+                f"(identify {cycle.identify_time:.2f}s, read {cycle.read_time:.2f}s, "
+                f"write {cycle.write_time:.2f}s)"
+            )
+        else:
+            self.dumper.log(f"\a*** FAIL *** board {cycle.board}: {cycle.error}")
+        self.dumper.log("Remove the board...")
+
+    def _write_log(self, cycle: StationCycle) -> None:
+        if not self.log_file:
+            return
+        fields = [
+            time.strftime("%Y-%m-%dT%H:%M:%S"),
+            self.dumper.port,
+            str(cycle.board),
+            f"0x{cycle.jtag_id:04X}",
+            "PASS" if cycle.passed else "FAIL",
+            f"{cycle.connect_time:.3f}",
+            f"{cycle.identify_time:.3f}",
+            f"{cycle.read_time:.3f}",
+            f"{cycle.write_time:.3f}",
+            f"{cycle.cycle_time:.3f}",
+            f"{cycle.removal_time:.3f}",
+            str(cycle.output or ""),
+            cycle.error.replace(",", ";"),
+        ]
+        with self._log_lock:
+            new_file = not self.log_file.exists()
+            with self.log_file.open("a") as file:
+                if new_file:
+                    file.write(self.LOG_HEADER + "\n")
+                file.write(",".join(fields) + "\n")
+
 
 def print_device_info(dumper: SinoWealthDumper) -> None:
     """Print target device information."""
@@ -368,6 +1948,200 @@ def print_device_info(dumper: SinoWealthDumper) -> None:
     print()
 
 
+def store_dump(
+    store: DumpStore,
+    dumper: SinoWealthDumper,
+    data: bytes,
+    start_address: int,
+    custom_block: bool,
+    elapsed: float,
+    options: bytes | None,
+    retries: int,
+    jtag_id: int | None = None,
+) -> str:
+    """
+    Add a finished dump together with the target's metadata to the store.
+
+    Args:
+        options: Code options, read once after connecting
+        retries: Verify retries of this dump (not the dumper's running total)
+
+    Returns:
+        SHA-256 of the stored image
+    """
+    if jtag_id is None:
+        jtag_id = dumper.get_id()
+    dump_id, sha256 = store.add_dump(
+        data,
+        source=dumper.port,
+        jtag_id=jtag_id,
+        chip_type=dumper.get_chip_type(),
+        flash_size=dumper.get_flash_size(),
+        start_address=start_address,
+        custom_block=custom_block,
+        options=options,
+        method=dumper.last_method,
+        elapsed=elapsed,
+        retries=retries,
+    )
+    dumper.log(f"Stored dump #{dump_id} as {sha256}")
+    return sha256
+
+
+def print_full_image(image: FullImage) -> None:
+    """Print the metadata and region table of a full image."""
+    for key, value in image.metadata.items():
+        print(f"{key + ':':<24}{value}")
+    print(f"{'Region':<15} {'Space':<7} {'Address':>8} {'Length':>8}  SHA-256")
+    for region in image.regions:
+        space = "custom" if region.custom_block else "flash"
+        print(
+            f"{region.name:<15} {space:<7} 0x{region.address:06X} {len(region.data):>8}  "
+            f"{region.sha256}"
+        )
+
+
+def capture_full_image(
+    dumper: SinoWealthDumper, output: Path, method: int, show_progress: bool = True
+) -> bool:
+    """Read all regions of the target into a full image container."""
+    print("Reading flash, custom block, code options and product block...")
+    start_time = time.time()
+    try:
+        image = dumper.read_full_image(method, progress_bar if show_progress else None)
+    except OSError as e:
+        print(f"\nError: {e}")
+        return False
+    if show_progress:
+        print()
+
+    image.save(output)
+    print(f"Saved full image to {output} in {time.time() - start_time:.1f}s")
+    print_full_image(image)
+    return True
+
+
+def read_consensus_to_file(
+    dumper: SinoWealthDumper,
+    output: Path,
+    start_address: int,
+    length: int,
+    method: int,
+    custom_block: bool,
+    passes: int,
+    progress_callback: Callable[[int, int], None] | None = None,
+) -> bool:
+    """
+    Dump a range by multi-pass consensus, writing the merged image and its
+    confidence map (<output>.confidence.json).
+
+    Returns:
+        True if every byte has a strict majority
+    """
+    try:
+        result = dumper.read_consensus(
+            start_address, length, method, custom_block, passes, progress_callback
+        )
+    except OSError as e:
+        print(f"\nError: {e}")
+        return False
+
+    confidence_path = output.with_name(output.name + ".confidence.json")
+    with dumper.phase("write"):
+        output.write_bytes(result.data)
+        confidence_path.write_text(json.dumps(result.confidence_map(), indent=2) + "\n")
+
+    print(
+        f"\n{result.passes} passes, {result.block_reads} block reads "
+        f"({result.block_reads * 16 / max(length, 1):.2f}x the range), "
+        f"{len(result.contested)} contested and {len(result.unresolved)} unresolved bytes"
+    )
+    print(f"Confidence map written to {confidence_path}")
+    return not result.unresolved
+
+
+def run_store_command(args: argparse.Namespace) -> None:
+    """Import, query or export the dump store without a device."""
+    store = DumpStore(args.store)
+    try:
+        if args.store_import:
+            for path in args.store_import:
+                dump_id, sha256 = store.import_file(path)
+                print(f"Imported {path} as dump #{dump_id}, image {sha256}")
+
+        if args.store_query:
+            query = args.store_query
+            if Path(query).is_file():
+                query = hashlib.sha256(Path(query).read_bytes()).hexdigest()
+            sha256 = store.resolve(query)
+            if not sha256:
+                print(f"No single image matches {args.store_query}")
+                sys.exit(1)
+            print(f"Image {sha256}:")
+            for dump in store.find_dumps(sha256=sha256):
+                jtag_id = f"0x{dump.jtag_id:04X}" if dump.jtag_id is not None else "-"
+                print(f"  #{dump.id:<6} {dump.time}  ID {jtag_id}  {dump.source}")
+
+        if args.store_export:
+            sha256 = store.resolve(args.store_export)
+            if not sha256 or not args.output:
+                print("Error: --store-export needs an unambiguous image hash and --output")
+                sys.exit(1)
+            args.output.write_bytes(store.get(sha256))
+            print(f"Exported image {sha256} to {args.output}")
+
+        stats = store.stats()
+        print(
+            f"Store: {stats['images']} images, {stats['dumps']} dumps, "
+            f"{stats['logical_bytes']} bytes in {stats['stored_bytes']} bytes of chunks"
+        )
+    finally:
+        store.close()
+
+
+def identify_firmware(
+    dumper: SinoWealthDumper,
+    database: FirmwareDatabase,
+    method: int,
+    verify: bool = False,
+) -> dict[str, Any] | None:
+    """
+    Match the target firmware against the database from sampled blocks.
+
+    Returns:
+        The matching database entry, or None
+    """
+    print("\n=== Firmware Identification ===")
+    start_time = time.time()
+    method = dumper.resolve_method(method)
+    fingerprint, options = dumper.read_fingerprint(method)
+    print(f"Fingerprint:      {fingerprint}")
+    print(f"Code Options:     {options.hex()}")
+
+    entry = database.lookup(fingerprint)
+    if not entry:
+        print("Match:            None")
+    else:
+        print(f"Match:            {entry['name']} (SHA-256 {entry['sha256']})")
+        if verify:
+            crc = dumper.crc_flash(0, entry["size"], method)
+            if crc is None:
+                print("Verify:           FAILED (CRC read error)")
+                entry = None
+            elif crc == entry["crc16"]:
+                print(f"Verify:           OK (CRC 0x{crc:04X})")
+            else:
+                print(
+                    f"Verify:           FAILED (CRC 0x{crc:04X}, "
+                    f"expected 0x{entry['crc16']:04X})"
+                )
+                entry = None
+
+    print(f"Identified in:    {time.time() - start_time:.2f}s")
+    print()
+    return entry
+
+
 def progress_bar(current: int, total: int, width: int = 50) -> None:
     """Display a progress bar."""
     percent = current / total if total > 0 else 0
@@ -378,6 +2152,100 @@ def progress_bar(current: int, total: int, width: int = 50) -> None:
     )
 
 
+def run_orchestrator(args: argparse.Namespace, method: int) -> None:
+    """Schedule dumps across all given ports and print the station summary."""
+    if not args.output or args.info:
+        print("Error: Multiple ports or --count require --output and no --info.")
+        sys.exit(1)
+
+    count = args.count if args.count is not None else len(args.port)
+    jobs = [
+        DumpJob(
+            output=job_output_path(args.output, n),
+            start_address=args.start,
+            length=args.length,
+            method=method,
+            custom_block=args.custom_block,
+            resume=args.resume,
+        )
+        for n in range(count)
+    ]
+
+    print(f"Scheduling {count} dumps across {len(args.port)} ports...")
+    store = DumpStore(args.store) if args.store else None
+    orchestrator = DumpOrchestrator(
+        args.port,
+        args.baudrate,
+        debug_rpc=args.debug_rpc,
+        store=store,
+        metrics_file=args.metrics,
+        record=args.record,
+    )
+    success = orchestrator.run(jobs, show_progress=not args.quiet)
+    orchestrator.print_summary()
+
+    if not success:
+        sys.exit(1)
+
+
+def run_stations(args: argparse.Namespace, method: int) -> None:
+    """Run a production station loop on every given port until interrupted."""
+    if not args.output:
+        print("Error: --station requires --output.")
+        sys.exit(1)
+
+    store = DumpStore(args.store) if args.store else None
+
+    stations: list[ProductionStation] = []
+    for port in args.port:
+        dumper = SinoWealthDumper(
+            port,
+            args.baudrate,
+            debug_rpc=args.debug_rpc,
+            record=port_trace_path(args.record, port, args.port),
+        )
+        if len(args.port) > 1:
+            dumper.log_prefix = f"[{port}] "
+        if args.metrics:
+            dumper.start_metrics()
+        dumper.log(f"Opening serial port {port}...")
+        if not dumper.open():
+            sys.exit(1)
+        stations.append(
+            ProductionStation(
+                dumper,
+                args.output,
+                method=method,
+                start_address=args.start,
+                length=args.length,
+                log_file=args.station_log,
+                store=store,
+                metrics_file=args.metrics,
+            )
+        )
+
+    threads = [
+        threading.Thread(target=station.run, args=(args.count,), daemon=True)
+        for station in stations
+    ]
+    try:
+        for thread in threads:
+            thread.start()
+        while any(thread.is_alive() for thread in threads):
+            for thread in threads:
+                thread.join(0.5)
+    except KeyboardInterrupt:
+        print("\nStation stopped.")
+    finally:
+        for station in stations:
+            print(f"{station.dumper.port}: {station.passed} passed, {station.failed} failed")
+            try:
+                station.dumper.release()
+            except Exception:
+                pass
+            station.dumper.close()
+
+
 def main() -> None:
     parser = argparse.ArgumentParser(
         description="SinoWealth 8051 Flash Dumper - Python RPC Client",
@@ -388,14 +2256,25 @@ Examples:
   %(prog)s -p /dev/ttyUSB0 -o firmware.bin
   %(prog)s -p /dev/ttyUSB0 -o firmware.bin --method icp
   %(prog)s -p /dev/ttyUSB0 -o partial.bin --start 0x1000 --length 4096
+  %(prog)s -p /dev/ttyUSB0 /dev/ttyUSB1 -o firmware.bin --count 8
+  %(prog)s -p /dev/ttyUSB0 -o firmware.bin --station --station-log station.csv
+  %(prog)s --fp-add known_v1.bin --fp-name "Build v1"
+  %(prog)s -p /dev/ttyUSB0 --identify --verify-match
+  %(prog)s -p /dev/ttyUSB0 --store dumps/
+  %(prog)s --store dumps/ --store-query firmware.bin
+  %(prog)s -p /dev/ttyUSB0 -o firmware.bin --metrics metrics.jsonl
+  %(prog)s -p /dev/ttyUSB0 -o target.swim --full-image
+  %(prog)s -p /dev/ttyUSB0 -o firmware.bin --passes 5
+  %(prog)s --export-image target.swim
         """,
     )
 
     parser.add_argument(
         "-p",
         "--port",
-        required=True,
-        help="Serial port (e.g., /dev/ttyUSB0, /dev/ttyACM0, COM3)",
+        nargs="+",
+        help="Serial port(s) (e.g., /dev/ttyUSB0, /dev/ttyACM0, COM3); "
+        "several ports are dumped concurrently",
     )
     parser.add_argument(
         "-b",
@@ -410,6 +2289,25 @@ Examples:
         type=Path,
         help="Output file for flash dump",
     )
+    parser.add_argument(
+        "--count",
+        type=int,
+        default=None,
+        help="Number of dumps to schedule across the ports (default: one per port), "
+        "in --station mode number of boards per port (default: unlimited)",
+    )
+    parser.add_argument(
+        "--station",
+        action="store_true",
+        help="Production mode: continuously wait for a board, dump, verify, "
+        "write and wait for its removal",
+    )
+    parser.add_argument(
+        "--station-log",
+        type=Path,
+        default=None,
+        help="CSV file the per-board cycle timings are appended to (--station mode)",
+    )
     parser.add_argument(
         "--info",
         action="store_true",
@@ -438,6 +2336,89 @@ Examples:
         action="store_true",
         help="Read from custom block area instead of main flash",
     )
+    parser.add_argument(
+        "--identify",
+        action="store_true",
+        help="Identify known firmware from a few sampled blocks; with --output and "
+        "--verify-match a verified match is saved from the database instead of being dumped",
+    )
+    parser.add_argument(
+        "--verify-match",
+        action="store_true",
+        help="Verify an --identify match by a CRC of the whole flash computed on the dumper",
+    )
+    parser.add_argument(
+        "--fp-db",
+        type=Path,
+        default=Path("fingerprints.json"),
+        help="Known firmware database (default: fingerprints.json)",
+    )
+    parser.add_argument(
+        "--fp-add",
+        type=Path,
+        metavar="IMAGE",
+        help="Add a full flash image to the known firmware database (no device needed)",
+    )
+    parser.add_argument(
+        "--fp-name",
+        help="Name of the image added by --fp-add (default: file name)",
+    )
+    parser.add_argument(
+        "--store",
+        type=Path,
+        metavar="DIR",
+        help="Add dumps to a content-addressed store with a SQLite index "
+        "(--output is optional then)",
+    )
+    parser.add_argument(
+        "--store-import",
+        type=Path,
+        nargs="+",
+        metavar="FILE",
+        help="Import existing .bin dumps into --store (no device needed)",
+    )
+    parser.add_argument(
+        "--store-query",
+        metavar="HASH|FILE",
+        help="List the dumps of an image in --store, by SHA-256 (prefix) or image file",
+    )
+    parser.add_argument(
+        "--store-export",
+        metavar="HASH",
+        help="Write an image from --store to --output",
+    )
+    parser.add_argument(
+        "--full-image",
+        action="store_true",
+        help="Read flash, custom block, code options and product block into one "
+        "container file (--output)",
+    )
+    parser.add_argument(
+        "--export-image",
+        type=Path,
+        metavar="FILE",
+        help="Check a --full-image container and write each region to "
+        "<FILE>_<region>.bin (no device needed)",
+    )
+    parser.add_argument(
+        "--passes",
+        type=int,
+        default=1,
+        metavar="K",
+        help="Read up to K passes with a power cycle in between and merge them by per-byte "
+        "majority; passes after the second only re-read contested blocks",
+    )
+    parser.add_argument(
+        "--metrics",
+        type=Path,
+        metavar="FILE",
+        help="Append a JSON Lines record with phase timings, counters and hash of every dump",
+    )
+    parser.add_argument(
+        "--resume",
+        action="store_true",
+        help="Continue an interrupted dump from the first missing block",
+    )
     parser.add_argument(
         "-q",
         "--quiet",
@@ -449,9 +2430,42 @@ Examples:
         action="store_true",
         help="Print all RPC calls and responses",
     )
+    parser.add_argument(
+        "--record",
+        type=Path,
+        metavar="FILE",
+        help="Record all RPC calls with timestamps to a trace for scripts/rpc_trace.py "
+        "(one file per port, named after the port, with several ports)",
+    )
 
     args = parser.parse_args()
 
+    if args.fp_add:
+        database = FirmwareDatabase(args.fp_db)
+        entry = database.add(args.fp_name or args.fp_add.stem, args.fp_add)
+        print(f"Added {entry['name']} to {args.fp_db}, fingerprint {entry['fingerprint']}")
+        return
+
+    if args.export_image:
+        try:
+            image = FullImage.load(args.export_image)
+        except (OSError, ValueError) as e:
+            print(f"Error: {e}")
+            sys.exit(1)
+        print_full_image(image)
+        for path in image.export(args.export_image):
+            print(f"Wrote {path}")
+        return
+
+    if args.store_import or args.store_query or args.store_export:
+        if not args.store:
+            parser.error("--store-import/--store-query/--store-export require --store")
+        run_store_command(args)
+        return
+
+    if not args.port:
+        parser.error("the following arguments are required: -p/--port")
+
     # Map method string to constant
     method_map = {
         "auto": ReadMethod.AUTO,
@@ -460,16 +2474,65 @@ Examples:
     }
     method = method_map[args.method]
 
+    if args.passes > 1 and (args.station or len(args.port) > 1 or (args.count or 1) > 1):
+        parser.error(
+            "--passes dumps a single board, it cannot be used with "
+            "--station, --count or several ports"
+        )
+
+    if args.passes > 1 and args.resume:
+        parser.error(
+            "--passes keeps the reads of all passes in memory, it cannot be used with --resume"
+        )
+
+    if args.full_image and (args.station or len(args.port) > 1 or (args.count or 1) > 1):
+        parser.error(
+            "--full-image captures a single board, it cannot be used with "
+            "--station, --count or several ports"
+        )
+
+    if args.full_image and (
+        args.passes > 1 or args.start or args.length is not None or args.custom_block or args.resume
+    ):
+        parser.error(
+            "--full-image captures the whole flash and custom block in one pass, it cannot be "
+            "used with --passes, --start, --length, --custom-block or --resume"
+        )
+
+    if args.station:
+        run_stations(args, method)
+        return
+
+    if len(args.port) > 1 or (args.count or 1) > 1:
+        run_orchestrator(args, method)
+        return
+
+    if args.full_image and not args.output:
+        parser.error("--full-image requires --output")
+
+    port = args.port[0]
+
+    store = DumpStore(args.store) if args.store else None
+    output = args.output
+    if store and not output:
+        output = store.scratch_path(Path(port).name)
+
     # Create dumper instance
-    dumper = SinoWealthDumper(args.port, args.baudrate, debug_rpc=args.debug_rpc)
+    dumper = SinoWealthDumper(port, args.baudrate, debug_rpc=args.debug_rpc, record=args.record)
+    metrics = dumper.start_metrics() if args.metrics else None
 
-    print(f"Opening serial port {args.port}...")
+    print(f"Opening serial port {port}...")
     if not dumper.open():
         sys.exit(1)
 
+    length = args.length or 0
+    complete = False
+    error = ""
+
     try:
         print("Connecting to target...")
         if not dumper.connect():
+            error = "failed to connect to target device"
             print("Error: Failed to connect to target device.")
             print("Make sure the target is powered and connected correctly.")
             sys.exit(1)
@@ -477,12 +2540,48 @@ Examples:
         print("Connected successfully!")
 
         # Always show basic info
-        if args.info or not args.output:
+        if args.info or not (output or args.identify):
             print_device_info(dumper)
 
+        if args.full_image:
+            if not capture_full_image(dumper, args.output, method, not args.quiet):
+                sys.exit(1)
+            return
+
+        options = dumper.read_code_options(method) if store else None
+        retries_before = dumper.read_retries
+
+        # Skip the dump if the firmware is a known one, confirmed by a CRC of the whole flash
+        saved = False
+        start_time = time.time()
+        if args.identify:
+            database = FirmwareDatabase(args.fp_db)
+            entry = identify_firmware(dumper, database, method, args.verify_match)
+            if entry and output and not args.verify_match:
+                print("Match not verified, dumping (use --verify-match to save the known image)")
+            elif entry and output and args.start == 0 and args.length is None:
+                image_path = database.image_path(entry)
+                if image_path.exists():
+                    data = image_path.read_bytes()
+                    output.write_bytes(data)
+                    print(f"Saved known image {image_path} to {output}")
+                    saved = True
+                    if metrics:
+                        DumpMetrics.append(
+                            args.metrics,
+                            metrics.record(
+                                dumper, args.output, 0, len(data), args.custom_block, True,
+                                data=data, identified=True,
+                            ),
+                        )
+                        metrics = None
+                else:
+                    print(f"Warning: Known image {image_path} is missing, dumping")
+
         # Dump flash if output specified
-        if args.output:
-            flash_size = dumper.get_flash_size()
+        if output and not saved:
+            with dumper.phase("handshake"):
+                flash_size = dumper.get_flash_size()
             length = (
                 args.length if args.length is not None else (flash_size - args.start)
             )
@@ -493,35 +2592,81 @@ Examples:
             callback = None if args.quiet else progress_bar
 
             start_time = time.time()
-            data = dumper.read_flash(
-                start_address=args.start,
-                length=length,
-                method=method,
-                custom_block=args.custom_block,
-                progress_callback=callback,
-            )
+            error = "dump interrupted"
+            if args.passes > 1:
+                complete = read_consensus_to_file(
+                    dumper, output, args.start, length, method, args.custom_block,
+                    args.passes, callback,
+                )
+            else:
+                complete = dumper.read_flash_to_file(
+                    output,
+                    start_address=args.start,
+                    length=length,
+                    method=method,
+                    custom_block=args.custom_block,
+                    progress_callback=callback,
+                    resume=args.resume,
+                )
             elapsed = time.time() - start_time
+            saved = complete
 
             if not args.quiet:
                 print()  # Newline after progress bar
 
-            if len(data) == length:
-                args.output.write_bytes(data)
-                speed = len(data) / elapsed if elapsed > 0 else 0
-                print(f"Saved {len(data)} bytes to {args.output}")
+            if complete:
+                error = ""
+                speed = dumper.bytes_read / elapsed if elapsed > 0 else 0
+                print(f"Saved {length} bytes to {output}")
                 print(f"Transfer speed: {speed:.1f} bytes/sec")
+            elif args.passes > 1:
+                error = "unresolved bytes"
+                print(f"Warning: Dump of {output} has bytes without a majority")
+                sys.exit(1)
             else:
-                print(f"Warning: Only read {len(data)} of {length} bytes")
-                if len(data) > 0:
-                    args.output.write_bytes(data)
-                    print(f"Partial dump saved to {args.output}")
+                error = "incomplete dump"
+                print(f"Warning: Dump of {output} is incomplete")
+                print("Reconnect and run the same command with --resume to continue.")
                 sys.exit(1)
 
-        if not args.info and not args.output:
-            print("No action specified. Use --info or --output.")
+        # Add the dump to the store, dropping the scratch file if there is no --output
+        if store and output and saved:
+            with dumper.phase("write"):
+                data = output.read_bytes()
+                store_dump(
+                    store,
+                    dumper,
+                    data,
+                    args.start,
+                    args.custom_block,
+                    time.time() - start_time,
+                    options,
+                    dumper.read_retries - retries_before,
+                )
+            if metrics and complete:
+                DumpMetrics.append(
+                    args.metrics,
+                    metrics.record(
+                        dumper, args.output, args.start, length, args.custom_block, True, data=data
+                    ),
+                )
+                metrics = None
+            if not args.output:
+                output.unlink()
+
+        if not args.info and not output and not args.identify:
+            print("No action specified. Use --info, --identify or --output.")
             print("Run with --help for usage information.")
 
     finally:
+        # Record every dump attempt, failed ones included
+        if metrics and (complete or error):
+            DumpMetrics.append(
+                args.metrics,
+                metrics.record(
+                    dumper, output, args.start, length, args.custom_block, complete, error
+                ),
+            )
         dumper.disconnect()
         dumper.close()
 
@@ -0,0 +1,594 @@
+#!/usr/bin/env python3
+"""
+SinoWealth 8051 Flash Dumper - Simulated dumper device
+
+Serves the same simpleRPC interface as rpc_loop() in the Arduino firmware,
+backed by a flash image file instead of a real target, so the host client
+can be tested and benchmarked on any Linux box:
+
+    python scripts/sinowealth_sim.py --image firmware.bin
+    python scripts/sinowealth_dumper.py -p /dev/pts/5 -o dump.bin
+
+The device is exposed on a pseudo-terminal (default) or a TCP socket. Every
+call can be delayed by a fixed latency plus the time its request and
+response bytes take on a serial line of the given baud rate.
+
+SimulatedFirmware can also be used in-process as the interface of a
+SinoWealthDumper, optionally wrapped in TimedInterface for the same timing.
+
+Copyright (C) 2024
+License: GPL-3.0
+"""
+
+import argparse
+import binascii
+import os
+import random
+import signal
+import socket
+import struct
+import sys
+import time
+import tty
+from collections.abc import Callable
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any
+
+PROTOCOL: bytes = b"simpleRPC"
+VERSION: tuple[int, int, int] = (3, 0, 0)
+LIST_REQUEST: int = 0xFF
+
+# Byte order and size_t type of the ATmega328P
+ENDIANNESS: str = "<"
+SIZE_T: str = "H"
+
+
+@dataclass(frozen=True)
+class RPCMethod:
+    """One exported function: name, struct formats of its return value and parameters."""
+
+    name: str
+    ret: str
+    params: str
+    doc: str
+
+    @property
+    def request_size(self) -> int:
+        """Bytes sent by the host: command index and parameters."""
+        return 1 + struct.calcsize(ENDIANNESS + self.params)
+
+    @property
+    def response_size(self) -> int:
+        """Bytes sent back by the device."""
+        return struct.calcsize(ENDIANNESS + self.ret) if self.ret else 0
+
+
+# Same order, types and documentation as the interface() call in src/rpc.cpp
+# (AVR: unsigned int is 16 bits, unsigned long is 32 bits)
+METHODS: list[RPCMethod] = [
+    RPCMethod("connect", "?", "", "connect: Connect to target device. @return: Success status."),
+    RPCMethod("disconnect", "", "", "disconnect: Disconnect from target device."),
+    RPCMethod("release", "", "", "release: Put all JTAG pins to Hi-Z."),
+    RPCMethod("getVREF", "?", "", "getVREF: Check if target is powered. @return: VREF level."),
+    RPCMethod("checkICP", "?", "", "checkICP: Check if ICP mode is working. @return: True if successful."),
+    RPCMethod("checkJTAG", "?", "", "checkJTAG: Check if JTAG mode is working. @return: True if successful."),
+    RPCMethod("getID", "H", "", "getID: Get JTAG ID code. @return: 16-bit ID code."),
+    RPCMethod("pingICP", "", "", "pingICP: Send ping to device in ICP mode."),
+    RPCMethod("readByteICP", "B", "L?", "readByteICP: Read byte via ICP. @address: Addr. @customBlock: Flag. @return: Byte."),
+    RPCMethod("readByteJTAG", "B", "L?", "readByteJTAG: Read byte via JTAG. @address: Addr. @customBlock: Flag. @return: Byte."),
+    RPCMethod("read16ICP", "?", "L?", "read16ICP: Read 16 bytes via ICP. @address: Addr. @customBlock: Flag. @return: OK."),
+    RPCMethod("read16JTAG", "?", "L?", "read16JTAG: Read 16 bytes via JTAG. @address: Addr. @customBlock: Flag. @return: OK."),
+    RPCMethod("getBufferByte", "B", "B", "getBufferByte: Get byte from buffer. @index: Index. @return: Byte."),
+    RPCMethod("detectReadMethod", "B", "", "detectReadMethod: Auto-detect read method. @return: 0=fail, 1=ICP, 2=JTAG."),
+    RPCMethod("crcFlash", "?", "LLB?", "crcFlash: CRC-16 of flash range. @address: Addr. @length: Len. @method: 1=ICP, 2=JTAG. @customBlock: Flag. @return: Success, CRC in buffer[0..1]."),
+    RPCMethod("getProductBlockAddress", "H", "", "getProductBlockAddress: Get product block address. @return: Address."),
+    RPCMethod("getCodeOptionsAddress", "H", "", "getCodeOptionsAddress: Get code options address. @return: Address."),
+    RPCMethod("getCodeOptionsSize", "H", "", "getCodeOptionsSize: Get code options size. @return: Size."),
+    RPCMethod("getCodeOptionsInFlash", "?", "", "getCodeOptionsInFlash: Check if options in flash. @return: Bool."),
+    RPCMethod("getChipType", "B", "", "getChipType: Get chip type. @return: Chip type."),
+    RPCMethod("getFlashSize", "L", "", "getFlashSize: Get flash size. @return: Size in bytes."),
+    RPCMethod("getProductBlock", "B", "", "getProductBlock: Get product block flag. @return: Flag."),
+    RPCMethod("getCustomBlock", "B", "", "getCustomBlock: Get custom block type. @return: Type."),
+]
+
+METHODS_BY_NAME: dict[str, RPCMethod] = {method.name: method for method in METHODS}
+
+
+@dataclass
+class SimulatedTarget:
+    """Target MCU contents and the config.h parameters of the simulated dumper."""
+
+    flash: bytes
+    custom_block: bytes = b""
+    chip_type: int = 2
+    product_block: int = 1
+    custom_block_type: int = 3
+    jtag_id: int = 0xF8A5
+    present: bool = True  # Board connected and powered (VREF high)
+
+    @classmethod
+    def from_image(
+        cls, image: bytes, flash_size: int | None = None, **kwargs: Any
+    ) -> "SimulatedTarget":
+        """Create a target from a flash image, padded with 0xFF to the flash size."""
+        flash_size = flash_size or len(image)
+        return cls(image[:flash_size].ljust(flash_size, b"\xff"), **kwargs)
+
+    @classmethod
+    def random(cls, flash_size: int = 32768, seed: int = 0, **kwargs: Any) -> "SimulatedTarget":
+        """Create a target with reproducible pseudo-random flash contents."""
+        image = random.Random(seed).randbytes(flash_size)
+        return cls(image, **kwargs)
+
+    def read(self, address: int, custom_block: bool) -> int:
+        """Read one byte; unprogrammed and out of range memory reads as 0xFF."""
+        memory = self.custom_block if custom_block else self.flash
+        if address < len(memory):
+            return memory[address]
+        return 0xFF
+
+
+class SimulatedFirmware:
+    """
+    Python model of src/rpc.cpp: one method per RPC function with the same
+    name and behaviour, so it can stand in for a simple_rpc Interface.
+    """
+
+    def __init__(self, target: SimulatedTarget, swap_time: float | None = None) -> None:
+        """
+        Args:
+            target: Simulated target
+            swap_time: Simulated operator: after release() the board is removed
+                and the next one is connected this many seconds later
+        """
+        self.target: SimulatedTarget = target
+        self.swap_time: float | None = swap_time
+        self.buffer: bytearray = bytearray(256)
+        self.calls: dict[str, int] = {}
+        self._jtag: bool = False
+        self._removed_at: float | None = None
+        self._removal_seen: bool = False
+
+    def close(self) -> None:
+        """Nothing to close, present for interface compatibility."""
+
+    def connect(self) -> bool:
+        # Like JTAG::connect, wait for VREF
+        while not self._board_present():
+            time.sleep(0.01)
+        self._jtag = True
+        return True
+
+    def disconnect(self) -> None:
+        pass
+
+    def release(self) -> None:
+        self._jtag = False
+        if self.swap_time is not None:
+            self.target.present = False
+            self._removed_at = time.monotonic()
+            self._removal_seen = False
+
+    def getVREF(self) -> bool:  # noqa: N802 - RPC name
+        return self._board_present()
+
+    def checkICP(self) -> bool:  # noqa: N802
+        return self._jtag
+
+    def checkJTAG(self) -> bool:  # noqa: N802
+        return self._jtag and self.getID() not in (0x0000, 0xFFFF)
+
+    def getID(self) -> int:  # noqa: N802
+        return self.target.jtag_id if self._jtag else 0
+
+    def pingICP(self) -> None:  # noqa: N802
+        pass
+
+    def readByteICP(self, address: int, customBlock: bool) -> int:  # noqa: N802, N803
+        if not self._jtag:
+            return 0xFF
+        return self.target.read(address, customBlock)
+
+    def readByteJTAG(self, address: int, customBlock: bool) -> int:  # noqa: N802, N803
+        if not self._jtag or customBlock:
+            return 0xFF
+        return self.target.read(address, False)
+
+    def read16ICP(self, address: int, customBlock: bool) -> bool:  # noqa: N802, N803
+        if not self._jtag:
+            return False
+        self._fill_buffer(address, 16, customBlock)
+        return True
+
+    def read16JTAG(self, address: int, customBlock: bool) -> bool:  # noqa: N802, N803
+        if not self._jtag or customBlock:
+            return False
+        self._fill_buffer(address, 16, False)
+        return True
+
+    def getBufferByte(self, index: int) -> int:  # noqa: N802
+        if index < len(self.buffer):
+            return self.buffer[index]
+        return 0xFF
+
+    def detectReadMethod(self) -> int:  # noqa: N802
+        if not self._jtag:
+            return 0
+        self._fill_buffer(0, 4, False)
+        if any(self.buffer[:4]):
+            return 1
+        return 0
+
+    def crcFlash(  # noqa: N802
+        self, address: int, length: int, method: int, customBlock: bool  # noqa: N803
+    ) -> bool:
+        if not self._jtag or (method == 2 and customBlock):
+            return False
+        data = bytes(self.target.read(address + n, customBlock) for n in range(length))
+        self.buffer[0:2] = binascii.crc_hqx(data, 0xFFFF).to_bytes(2, "little")
+        return True
+
+    def getProductBlockAddress(self) -> int:  # noqa: N802
+        return {2: 0x0A00, 3: 0x1200, 4: 0x2200}.get(self.target.custom_block_type, 0)
+
+    def getCodeOptionsAddress(self) -> int:  # noqa: N802
+        chip_type = self.target.chip_type
+        options_address = len(self.target.flash) - self.getCodeOptionsSize()
+        custom_block_type = self.target.custom_block_type
+        if custom_block_type == 2 and chip_type == 2:
+            options_address = 0x0800
+        elif custom_block_type == 3 and chip_type in (2, 7):
+            options_address = 0x1000
+        elif custom_block_type == 4:
+            options_address = 0x2000
+        return options_address
+
+    def getCodeOptionsSize(self) -> int:  # noqa: N802
+        if self.target.custom_block_type == 3 and self.target.chip_type == 7:
+            return 512
+        if self.target.custom_block_type == 6:
+            return 32
+        return 64
+
+    def getCodeOptionsInFlash(self) -> bool:  # noqa: N802
+        chip_type = self.target.chip_type
+        custom_block_type = self.target.custom_block_type
+        if custom_block_type == 2 and chip_type == 2:
+            return False
+        if custom_block_type == 3 and chip_type in (2, 7):
+            return False
+        return custom_block_type != 4
+
+    def getChipType(self) -> int:  # noqa: N802
+        return self.target.chip_type
+
+    def getFlashSize(self) -> int:  # noqa: N802
+        return len(self.target.flash)
+
+    def getProductBlock(self) -> int:  # noqa: N802
+        return self.target.product_block
+
+    def getCustomBlock(self) -> int:  # noqa: N802
+        return self.target.custom_block_type
+
+    def call(self, name: str, *args: Any) -> Any:
+        """Invoke an RPC function by name, counting the calls."""
+        self.calls[name] = self.calls.get(name, 0) + 1
+        return getattr(self, name)(*args)
+
+    def _board_present(self) -> bool:
+        # The removed board is reported on at least one poll, even with a zero swap time
+        if self._removed_at is not None:
+            elapsed = time.monotonic() - self._removed_at
+            if self._removal_seen and elapsed >= (self.swap_time or 0.0):
+                self.target.present = True
+                self._removed_at = None
+            else:
+                self._removal_seen = True
+        return self.target.present
+
+    def _fill_buffer(self, address: int, size: int, custom_block: bool) -> None:
+        for n in range(size):
+            self.buffer[n] = self.target.read(address + n, custom_block)
+
+
+class CallTiming:
+    """
+    Time model of one RPC call: fixed latency, target-side time of the
+    function and serial transfer of its bytes.
+    """
+
+    def __init__(
+        self,
+        latency: float = 0.0,
+        baudrate: int = 0,
+        target_time: dict[str, float] | None = None,
+    ) -> None:
+        """
+        Args:
+            latency: Fixed delay per call in seconds (firmware and USB turnaround)
+            baudrate: Serial baud rate to model, 0 to not model the transfer
+            target_time: Target-side time per RPC name in seconds, e.g. from the native build
+        """
+        self.latency: float = latency
+        self.baudrate: int = baudrate
+        self.target_time: dict[str, float] = target_time or {}
+
+    def duration(self, method: RPCMethod) -> float:
+        """Modelled duration of a call (8N1: 10 bits per byte)."""
+        duration = self.latency + self.target_time.get(method.name, 0.0)
+        if self.baudrate:
+            duration += (method.request_size + method.response_size) * 10 / self.baudrate
+        return duration
+
+    def wait(self, method: RPCMethod, since: float) -> None:
+        """Sleep until the modelled duration of a call started at `since` has passed."""
+        remaining = since + self.duration(method) - time.perf_counter()
+        if remaining > 0:
+            time.sleep(remaining)
+
+
+class TimedInterface:
+    """In-process interface to a SimulatedFirmware, delayed like the serial link would be."""
+
+    def __init__(self, firmware: SimulatedFirmware, timing: CallTiming) -> None:
+        self._firmware: SimulatedFirmware = firmware
+        self._timing: CallTiming = timing
+
+    def close(self) -> None:
+        """Nothing to close, present for interface compatibility."""
+
+    def __getattr__(self, name: str) -> Callable[..., Any]:
+        method = METHODS_BY_NAME.get(name)
+        if method is None:
+            raise AttributeError(name)
+
+        def call(*args: Any) -> Any:
+            start_time = time.perf_counter()
+            result = self._firmware.call(name, *args)
+            self._timing.wait(method, start_time)
+            return result
+
+        return call
+
+
+class NoResponse(Exception):
+    """Raised by a firmware model to leave a call unanswered, like a lost response."""
+
+
+class SimpleRPCServer:
+    """simpleRPC (protocol version 3) device side, served from a firmware model."""
+
+    def __init__(self, firmware: Any, timing: CallTiming, verbose: bool = False) -> None:
+        """
+        Args:
+            firmware: Object with one method per entry of METHODS
+            timing: Per-call timing model
+            verbose: Print every call
+        """
+        self.firmware: Any = firmware
+        self.timing: CallTiming = timing
+        self.verbose: bool = verbose
+
+    def describe(self) -> bytes:
+        """Interface description sent in reply to the list request."""
+        data = PROTOCOL + b"\0" + bytes(VERSION)
+        data += (ENDIANNESS + SIZE_T).encode() + b"\0"
+        for method in METHODS:
+            params = " ".join(method.params)
+            data += f"{method.ret}: {params};{method.doc}".encode() + b"\0"
+        return data + b"\0"
+
+    def serve(self, read: Callable[[int], bytes], write: Callable[[bytes], None]) -> None:
+        """Handle requests until the reader reports end of stream."""
+        while True:
+            command = read(1)
+            if not command:
+                return
+            start_time = time.perf_counter()
+
+            if command[0] == LIST_REQUEST:
+                write(self.describe())
+                continue
+            if command[0] >= len(METHODS):
+                print(f"Unknown command {command[0]}", file=sys.stderr)
+                continue
+
+            method = METHODS[command[0]]
+            payload = read(method.request_size - 1) if method.params else b""
+            args = struct.unpack(ENDIANNESS + method.params, payload) if method.params else ()
+            try:
+                result = self._call(method, args)
+            except NoResponse:
+                if self.verbose:
+                    print(f"{method.name}{args} -> no response")
+                continue
+
+            self.timing.wait(method, start_time)
+            if method.ret:
+                write(struct.pack(ENDIANNESS + method.ret, result))
+
+            if self.verbose:
+                print(f"{method.name}{args} -> {result!r}")
+
+    def _call(self, method: RPCMethod, args: tuple[Any, ...]) -> Any:
+        if hasattr(self.firmware, "call"):
+            return self.firmware.call(method.name, *args)
+        return getattr(self.firmware, method.name)(*args)
+
+
+def _read_exactly(fd_read: Callable[[int], bytes], size: int) -> bytes:
+    data = b""
+    while len(data) < size:
+        chunk = fd_read(size - len(data))
+        if not chunk:
+            return b""
+        data += chunk
+    return data
+
+
+def serve_pty(server: SimpleRPCServer, link: Path | None = None) -> None:
+    """Serve on a new pseudo-terminal, optionally symlinked to a stable path."""
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    slave_name = os.ttyname(slave)
+    if link:
+        link.unlink(missing_ok=True)
+        link.symlink_to(slave_name)
+        print(f"Serving on {slave_name} ({link})")
+    else:
+        print(f"Serving on {slave_name}")
+    sys.stdout.flush()
+
+    def read(size: int) -> bytes:
+        return _read_exactly(lambda n: os.read(master, n), size)
+
+    def write(data: bytes) -> None:
+        os.write(master, data)
+
+    # The slave end stays open here, so clients may close and reopen the port
+    try:
+        server.serve(read, write)
+    finally:
+        os.close(master)
+        os.close(slave)
+        if link:
+            link.unlink(missing_ok=True)
+
+
+def serve_tcp(server: SimpleRPCServer, port: int) -> None:
+    """Serve clients one after another on a TCP port (pyserial URL socket://host:port)."""
+    with socket.create_server(("127.0.0.1", port)) as listener:
+        print(f"Serving on socket://127.0.0.1:{port}")
+        sys.stdout.flush()
+        while True:
+            connection, _ = listener.accept()
+            with connection:
+                connection.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                server.serve(
+                    lambda size: _read_exactly(connection.recv, size), connection.sendall
+                )
+
+
+def build_target(args: argparse.Namespace) -> SimulatedTarget:
+    """Create the simulated target from command line arguments."""
+    options: dict[str, Any] = {
+        "chip_type": args.chip_type,
+        "product_block": args.product_block,
+        "custom_block_type": args.custom_block_type,
+        "jtag_id": args.jtag_id,
+    }
+    if args.custom_image:
+        options["custom_block"] = args.custom_image.read_bytes()
+    if args.image:
+        return SimulatedTarget.from_image(args.image.read_bytes(), args.flash_size, **options)
+    return SimulatedTarget.random(args.flash_size or 32768, args.seed, **options)
+
+
+def add_target_arguments(parser: argparse.ArgumentParser) -> None:
+    """Command line options describing the simulated target, shared with other tools."""
+    parser.add_argument(
+        "--image",
+        type=Path,
+        help="Flash image of the target (default: pseudo-random contents)",
+    )
+    parser.add_argument(
+        "--custom-image",
+        type=Path,
+        help="Custom block image of the target",
+    )
+    parser.add_argument(
+        "--flash-size",
+        type=lambda x: int(x, 0),
+        default=None,
+        help="Flash size (default: image size, or 32768 without an image)",
+    )
+    parser.add_argument("--seed", type=int, default=0, help="Seed of the random image")
+    parser.add_argument("--chip-type", type=int, default=2, help="CHIP_TYPE (default: 2)")
+    parser.add_argument(
+        "--product-block", type=int, default=1, help="CHIP_PRODUCT_BLOCK (default: 1)"
+    )
+    parser.add_argument(
+        "--custom-block-type", type=int, default=3, help="CHIP_CUSTOM_BLOCK (default: 3)"
+    )
+    parser.add_argument(
+        "--jtag-id",
+        type=lambda x: int(x, 0),
+        default=0xF8A5,
+        help="JTAG ID code (default: 0xF8A5)",
+    )
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description="SinoWealth 8051 Flash Dumper - Simulated dumper device",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --image firmware.bin
+  %(prog)s --image firmware.bin --latency 0.002 --baudrate 115200 --link /tmp/ttySIM
+  %(prog)s --flash-size 0x10000 --tcp 5555
+  %(prog)s --image firmware.bin --swap-time 2 --link /tmp/ttySIM
+        """,
+    )
+    add_target_arguments(parser)
+    parser.add_argument(
+        "--latency",
+        type=float,
+        default=0.0,
+        help="Fixed delay per RPC call in seconds (default: 0)",
+    )
+    parser.add_argument(
+        "--baudrate",
+        type=int,
+        default=0,
+        help="Model the transfer time at this baud rate (default: 0, not modelled)",
+    )
+    parser.add_argument(
+        "--swap-time",
+        type=float,
+        default=None,
+        help="Simulate an operator for station mode: after the pins are released the "
+        "board is removed and the next one connected this many seconds later",
+    )
+    parser.add_argument(
+        "--link",
+        type=Path,
+        help="Symlink the pseudo-terminal to this path",
+    )
+    parser.add_argument(
+        "--tcp",
+        type=int,
+        metavar="PORT",
+        help="Serve on a local TCP port instead of a pseudo-terminal",
+    )
+    parser.add_argument(
+        "-v",
+        "--verbose",
+        action="store_true",
+        help="Print every RPC call",
+    )
+
+    args = parser.parse_args()
+
+    firmware = SimulatedFirmware(build_target(args), args.swap_time)
+    server = SimpleRPCServer(firmware, CallTiming(args.latency, args.baudrate), args.verbose)
+
+    # Print the call counts on kill as well
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+
+    try:
+        if args.tcp:
+            serve_tcp(server, args.tcp)
+        else:
+            serve_pty(server, args.link)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for name, count in sorted(firmware.calls.items()):
+            print(f"{name:<24} {count}")
+
+
+if __name__ == "__main__":
+    main()
@@ -14,7 +14,6 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <avr/io.h>
 #include <util/delay.h>
 
 #include "config.h"
@@ -23,11 +22,11 @@
 JTAG::JTAG()
 {
 	// Set all pins to Hi-Z/Input initially
-	DDRD &= ~_BV(PIN_VREF);
-	DDRD &= ~_BV(PIN_TDO);
-	DDRD &= ~_BV(PIN_TDI);
-	DDRD &= ~_BV(PIN_TMS);
-	DDRD &= ~_BV(PIN_TCK);
+	PinVREF::input();
+	PinTDO::input();
+	PinTDI::input();
+	PinTMS::input();
+	PinTCK::input();
 }
 
 void JTAG::connect()
@@ -35,75 +34,75 @@ void JTAG::connect()
 	// Wait for Vref since we don't have reset pin - this is
 	// an alternative that does not require power switch/relay.
 	// TODO: Power cycle via high side switch/relay
-	while (!getBit(PIN_VREF)) {
+	while (!PinVREF::read()) {
 		_delay_us(100);
 	}
 
 	// Configure output pins after Vref check passes
-	DDRD |= _BV(PIN_TDI);
-	DDRD |= _BV(PIN_TMS);
-	DDRD |= _BV(PIN_TCK);
+	PinTDI::output();
+	PinTMS::output();
+	PinTCK::output();
 
 	// Do not power the target via I/O leakage
-	clrBit(PIN_TCK);
-	clrBit(PIN_TDI);
-	clrBit(PIN_TMS);
+	PinTCK::clear();
+	PinTDI::clear();
+	PinTMS::clear();
 
-	setBit(PIN_TCK);
-	setBit(PIN_TDI);
-	setBit(PIN_TMS);
+	PinTCK::set();
+	PinTDI::set();
+	PinTMS::set();
 
 	_delay_us(500);
 
-	clrBit(PIN_TCK);
+	PinTCK::clear();
 	_delay_us(1);
-	setBit(PIN_TCK);
+	PinTCK::set();
 	_delay_us(50);
 
 	for (uint8_t n = 0; n < 165; ++n)
 	{
-		clrBit(PIN_TMS);
+		PinTMS::clear();
 		_delay_us(2);
-		setBit(PIN_TMS);
+		PinTMS::set();
 		_delay_us(2);
 	}
 
 	for (uint8_t n = 0; n < 105; ++n)
 	{
-		clrBit(PIN_TDI);
+		PinTDI::clear();
 		_delay_us(2);
-		setBit(PIN_TDI);
+		PinTDI::set();
 		_delay_us(2);
 	}
 
 	for (uint8_t n = 0; n < 90; ++n)
 	{
-		clrBit(PIN_TCK);
+		PinTCK::clear();
 		_delay_us(2);
-		setBit(PIN_TCK);
+		PinTCK::set();
 		_delay_us(2);
 	}
 
 	for (uint16_t n = 0; n < 25600; ++n)
 	{
-		clrBit(PIN_TMS);
+		PinTMS::clear();
 		_delay_us(2);
-		setBit(PIN_TMS);
+		PinTMS::set();
 		_delay_us(2);
 	}
 
 	_delay_us(8);
 
-	clrBit(PIN_TMS);
+	PinTMS::clear();
 
 	m_mode = Mode::ICP;
 	startMode();
 
 	for (uint16_t n = 0; n < 25600; ++n)
 	{
-		setBit(PIN_TCK);
+		PinTCK::set();
 		_delay_us(2);
-		clrBit(PIN_TCK);
+		PinTCK::clear();
 		_delay_us(2);
 	}
 
@@ -117,6 +116,26 @@ void JTAG::disconnect()
 	switchMode(Mode::ICP);
 }
 
+void JTAG::release()
+{
+	// Back to Hi-Z (drive low first so pull-ups are not enabled on the way),
+	// the next target must not be powered via I/O leakage before its Vref rises
+	PinTCK::clear();
+	PinTDI::clear();
+	PinTMS::clear();
+
+	PinTDI::input();
+	PinTMS::input();
+	PinTCK::input();
+
+	m_mode = Mode::ERROR;
+}
+
+bool JTAG::checkVREF() const
+{
+	return PinVREF::read();
+}
+
 void JTAG::reset()
 {
 	if (m_mode == Mode::ERROR)
@@ -128,17 +147,17 @@ void JTAG::reset()
 		for (uint8_t n = 0; n < 35; ++n)
 			nextState(1);
 
-		setBit(PIN_TCK);
+		PinTCK::set();
 
-		clrBit(PIN_TMS);
+		PinTMS::clear();
 	}
 	else
 	{
-		setBit(PIN_TCK);
+		PinTCK::set();
 
-		setBit(PIN_TMS);
+		PinTMS::set();
 		_delay_us(2);
-		clrBit(PIN_TMS);
+		PinTMS::clear();
 		_delay_us(2);
 	}
 
@@ -199,30 +218,30 @@ void JTAG::switchMode(Mode mode)
 
 void JTAG::startMode() const
 {
-	clrBit(PIN_TCK);
+	PinTCK::clear();
 	_delay_us(2);
 
 	for (uint8_t m = 0x80; m; m >>= 1)
 	{
 		if (uint8_t(m_mode) & m)
-			setBit(PIN_TDI);
+			PinTDI::set();
 		else
-			clrBit(PIN_TDI);
+			PinTDI::clear();
 
-		setBit(PIN_TCK);
+		PinTCK::set();
 		_delay_us(2);
-		clrBit(PIN_TCK);
+		PinTCK::clear();
 		_delay_us(2);
 	}
 
-	setBit(PIN_TCK);
+	PinTCK::set();
 	_delay_us(2);
-	clrBit(PIN_TCK);
+	PinTCK::clear();
 	_delay_us(2);
 
-	setBit(PIN_TCK);
+	PinTCK::set();
 	_delay_us(2);
-	clrBit(PIN_TCK);
+	PinTCK::clear();
 	_delay_us(2);
 }
 
@@ -371,16 +390,16 @@ void JTAG::sendICPData(uint8_t value)
 	for (uint8_t m = 0x80; m; m >>= 1)
 	{
 		if (value & m)
-			setBit(PIN_TDI);
+			PinTDI::set();
 		else
-			clrBit(PIN_TDI);
+			PinTDI::clear();
 
 		pulseClock();
 	}
 
 	pulseClock();
 
-	clrBit(PIN_TDI);
+	PinTDI::clear();
 }
 
 uint8_t JTAG::receiveICPData()
@@ -390,7 +409,7 @@ uint8_t JTAG::receiveICPData()
 	{
 		pulseClock();
 
-		if (getBit(PIN_TDO))
+		if (PinTDO::read())
 			value |= m;
 	}
 
@@ -402,16 +421,16 @@ uint8_t JTAG::receiveICPData()
 bool JTAG::nextState(bool tms)
 {
 	if (tms)
-		setBit(PIN_TMS);
+		PinTMS::set();
 	else
-		clrBit(PIN_TMS);
+		PinTMS::clear();
 
-	setBit(PIN_TCK);
+	PinTCK::set();
 	_delay_us(2);
 
-	bool b = getBit(PIN_TDO);
+	bool b = PinTDO::read();
 
-	clrBit(PIN_TCK);
+	PinTCK::clear();
 	_delay_us(2);
 
 	return b;
@@ -420,9 +439,9 @@ bool JTAG::nextState(bool tms)
 bool JTAG::nextState(bool tms, bool out)
 {
 	if (out)
-		setBit(PIN_TDI);
+		PinTDI::set();
 	else
-		clrBit(PIN_TDI);
+		PinTDI::clear();
 
 	return nextState(tms);
 }
@@ -430,9 +449,9 @@ bool JTAG::nextState(bool tms, bool out)
 void JTAG::pulseClock()
 {
 	_delay_us(1);
-	setBit(PIN_TCK);
+	PinTCK::set();
 	_delay_us(1);
-	clrBit(PIN_TCK);
+	PinTCK::clear();
 }
 
 void JTAG::pulseClocks(uint8_t count)
@@ -0,0 +1,57 @@
+/*
+   https://github.com/gashtaan/sinowealth-8051-dumper
+
+   Copyright (C) 2023, Michal Kovacik
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License version 3, as
+   published by the Free Software Foundation.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Host port backend for pin.h: port writes and pin reads go to the software target model
+
+#pragma once
+
+#include <stdint.h>
+
+void nativeWritePort(char port, uint8_t value);
+void nativeWriteDirection(char port, uint8_t value);
+uint8_t nativeReadPins(char port, uint8_t value);
+
+template <char Name>
+struct NativePort
+{
+	static constexpr char name = Name;
+
+	static void set(uint8_t mask) { write(s_value | mask); }
+	static void clear(uint8_t mask) { write(s_value & ~mask); }
+	static uint8_t read(uint8_t mask) { return nativeReadPins(Name, s_value) & mask; }
+	static void output(uint8_t mask) { writeDirection(s_direction | mask); }
+	static void input(uint8_t mask) { writeDirection(s_direction & ~mask); }
+
+private:
+	static void write(uint8_t value)
+	{
+		s_value = value;
+		nativeWritePort(Name, value);
+	}
+
+	static void writeDirection(uint8_t value)
+	{
+		s_direction = value;
+		nativeWriteDirection(Name, value);
+	}
+
+	static inline uint8_t s_value = 0;
+	static inline uint8_t s_direction = 0;
+};
+
+typedef NativePort<'B'> PortB;
+typedef NativePort<'C'> PortC;
+typedef NativePort<'D'> PortD;
@@ -0,0 +1,181 @@
+/*
+   https://github.com/gashtaan/sinowealth-8051-dumper
+
+   Copyright (C) 2023, Michal Kovacik
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License version 3, as
+   published by the Free Software Foundation.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Host build entry point: runs the unmodified JTAG driver and RPC functions
+// against the bit-level target model, checks the data read back and reports
+// clock and delay counts of every operation.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "config.h"
+#include "rpc.h"
+#include "target_model.h"
+
+static const uint16_t TARGET_ID = 0xF8A5;
+static const uint32_t CUSTOM_BLOCK_SIZE = 0x1400;
+
+static unsigned int s_failures = 0;
+
+static void check(bool condition, const char* what, uint32_t address = 0)
+{
+	if (!condition)
+	{
+		printf("FAIL: %s (0x%06lX)\n", what, (unsigned long)address);
+		++s_failures;
+	}
+}
+
+static std::vector<uint8_t> randomImage(uint32_t size, uint32_t seed)
+{
+	std::vector<uint8_t> image(size);
+	for (uint32_t n = 0; n < size; ++n)
+	{
+		seed = seed * 1103515245 + 12345;
+		image[n] = seed >> 16;
+	}
+	return image;
+}
+
+static uint16_t crc16(const uint8_t* data, uint32_t length)
+{
+	uint16_t crc = 0xFFFF;
+	while (length-- > 0)
+	{
+		crc ^= uint16_t(*data++) << 8;
+		for (uint8_t n = 0; n < 8; ++n)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+static uint16_t bufferCrc()
+{
+	return rpc_getBufferByte(0) | rpc_getBufferByte(1) << 8;
+}
+
+static void report(const char* name, uint32_t count, uint32_t bytes)
+{
+	const TargetModel::Counters& c = targetModel().counters();
+	double us = c.delayUs / count;
+	printf("%-16s %10.1f %10.1f %10.1f %12.1f", name, double(c.clocks) / count, double(c.jtagShifts) / count, double(c.icpFrames) / count, us);
+	if (bytes)
+		printf(" %12.1f", bytes * 1e6 / us);
+	printf("\n");
+}
+
+int main()
+{
+	std::vector<uint8_t> flash = randomImage(CHIP_FLASH_SIZE, 1);
+	std::vector<uint8_t> customBlock = randomImage(CUSTOM_BLOCK_SIZE, 2);
+	targetModel().load(flash, customBlock, TARGET_ID);
+
+	rpc_init();
+
+	printf("%-16s %10s %10s %10s %12s %12s\n", "operation", "clocks", "shifts", "frames", "delay [us]", "max [B/s]");
+
+	targetModel().resetCounters();
+	check(rpc_connect(), "connect");
+	report("connect", 1, 0);
+
+	targetModel().resetCounters();
+	check(rpc_getID() == TARGET_ID, "getID");
+	report("getID", 1, 0);
+
+	targetModel().resetCounters();
+	check(rpc_checkICP(), "checkICP");
+	report("checkICP", 1, 0);
+
+	check(rpc_checkJTAG(), "checkJTAG");
+	check(rpc_detectReadMethod() == 1, "detectReadMethod");
+
+	// full flash via both 16-byte reads, mode switch included once per method
+	targetModel().resetCounters();
+	uint32_t reads = 0;
+	for (uint32_t address = 0; address < CHIP_FLASH_SIZE; address += 16, ++reads)
+	{
+		check(rpc_read16ICP(address, false), "read16ICP", address);
+		for (uint8_t n = 0; n < 16; ++n)
+			check(rpc_getBufferByte(n) == flash[address + n], "read16ICP data", address + n);
+	}
+	report("read16ICP", reads, 16);
+
+	targetModel().resetCounters();
+	reads = 0;
+	for (uint32_t address = 0; address < CHIP_FLASH_SIZE; address += 16, ++reads)
+	{
+		check(rpc_read16JTAG(address, false), "read16JTAG", address);
+		for (uint8_t n = 0; n < 16; ++n)
+			check(rpc_getBufferByte(n) == flash[address + n], "read16JTAG data", address + n);
+	}
+	report("read16JTAG", reads, 16);
+
+	targetModel().resetCounters();
+	reads = 0;
+	for (uint32_t address = 0; address < CUSTOM_BLOCK_SIZE; address += 16, ++reads)
+	{
+		check(rpc_read16ICP(address, true), "read16ICP custom block", address);
+		for (uint8_t n = 0; n < 16; ++n)
+			check(rpc_getBufferByte(n) == customBlock[address + n], "read16ICP custom block data", address + n);
+	}
+	report("read16ICP custom", reads, 16);
+	check(!rpc_read16JTAG(0, true), "read16JTAG custom block refused");
+
+	targetModel().resetCounters();
+	reads = 0;
+	for (uint32_t address = 0; address < CHIP_FLASH_SIZE; address += 257, ++reads)
+		check(rpc_readByteICP(address, false) == flash[address], "readByteICP", address);
+	report("readByteICP", reads, 1);
+
+	targetModel().resetCounters();
+	reads = 0;
+	for (uint32_t address = 0; address < CHIP_FLASH_SIZE; address += 257, ++reads)
+		check(rpc_readByteJTAG(address, false) == flash[address], "readByteJTAG", address);
+	report("readByteJTAG", reads, 1);
+
+	targetModel().resetCounters();
+	check(rpc_crcFlash(0, CHIP_FLASH_SIZE, 1, false) && bufferCrc() == crc16(flash.data(), CHIP_FLASH_SIZE), "crcFlash ICP");
+	report("crcFlash ICP", 1, CHIP_FLASH_SIZE);
+
+	targetModel().resetCounters();
+	check(rpc_crcFlash(0, CHIP_FLASH_SIZE, 2, false) && bufferCrc() == crc16(flash.data(), CHIP_FLASH_SIZE), "crcFlash JTAG");
+	report("crcFlash JTAG", 1, CHIP_FLASH_SIZE);
+
+	// board swap: release the pins, VREF follows the target supply, then connect again
+	check(rpc_getVREF(), "getVREF powered");
+	rpc_release();
+	check(!targetModel().driven(), "release");
+	targetModel().setPowered(false);
+	check(!rpc_getVREF(), "getVREF unpowered");
+	targetModel().setPowered(true);
+	check(rpc_getVREF(), "getVREF powered again");
+	check(rpc_connect(), "connect after power cycle");
+	check(targetModel().driven(), "connect drives pins");
+	check(rpc_getID() == TARGET_ID, "getID after power cycle");
+	check(rpc_read16ICP(CHIP_FLASH_SIZE - 16, false) && rpc_getBufferByte(15) == flash[CHIP_FLASH_SIZE - 1], "read16ICP after power cycle");
+
+	rpc_disconnect();
+
+	if (s_failures)
+	{
+		printf("%u checks failed\n", s_failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("All checks passed\n");
+	return EXIT_SUCCESS;
+}
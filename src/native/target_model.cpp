@@ -0,0 +1,405 @@
+/*
+   https://github.com/gashtaan/sinowealth-8051-dumper
+
+   Copyright (C) 2023, Michal Kovacik
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License version 3, as
+   published by the Free Software Foundation.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Arduino.h>
+#include <avr/io.h>
+#include <util/delay.h>
+
+#include "config.h"
+#include "jtag.h"
+#include "target_model.h"
+
+NativeSerial Serial;
+
+void nativeWritePort(char port, uint8_t value)
+{
+	targetModel().writePort(port, value);
+}
+
+void nativeWriteDirection(char port, uint8_t value)
+{
+	targetModel().writeDirection(port, value);
+}
+
+uint8_t nativeReadPins(char port, uint8_t value)
+{
+	return targetModel().readPins(port, value);
+}
+
+void _delay_us(double us)
+{
+	targetModel().delay(us);
+}
+
+TargetModel& targetModel()
+{
+	static TargetModel model;
+	return model;
+}
+
+TargetModel::TargetModel()
+{
+}
+
+void TargetModel::load(const std::vector<uint8_t>& flash, const std::vector<uint8_t>& customBlock, uint16_t id)
+{
+	m_flash = flash;
+	m_customBlock = customBlock;
+	m_id = id;
+}
+
+template <class P>
+bool TargetModel::level() const
+{
+	return m_ports[P::Port::name - 'B'] & P::mask;
+}
+
+template <class P>
+bool TargetModel::isOutput() const
+{
+	return m_directions[P::Port::name - 'B'] & P::mask;
+}
+
+void TargetModel::setPowered(bool powered)
+{
+	if (!powered)
+	{
+		m_mode = Mode::OFF;
+		m_tap = TAPState::TEST_LOGIC_RESET;
+		m_tdo = false;
+		m_bank = 0;
+	}
+	m_powered = powered;
+}
+
+bool TargetModel::driven() const
+{
+	return isOutput<PinTCK>() || isOutput<PinTMS>() || isOutput<PinTDI>();
+}
+
+void TargetModel::writePort(char port, uint8_t value)
+{
+	m_ports[port - 'B'] = value;
+
+	if (!m_powered)
+		return;
+
+	bool tck = level<PinTCK>();
+	bool tms = level<PinTMS>();
+	bool tdi = level<PinTDI>();
+
+	bool tckChanged = tck != m_tck;
+	bool tmsChanged = tms != m_tms;
+	m_tck = tck;
+	m_tms = tms;
+
+	if (tckChanged)
+	{
+		if (tck)
+			risingEdge(tms, tdi);
+		else
+			fallingEdge();
+	}
+
+	// TMS falling while TCK is high ends the connect sequence and both mode resets,
+	// the target then waits for a mode byte
+	if (tmsChanged && !tms && tck)
+	{
+		m_mode = Mode::READY;
+		m_entryClocks = 0;
+		m_entryByte = 0;
+		m_tdo = false;
+	}
+}
+
+uint8_t TargetModel::readPins(char port, uint8_t value) const
+{
+	// inputs driven by the target, everything else reads back the port latch
+	if (PinVREF::Port::name == port)
+	{
+		value &= ~PinVREF::mask;
+		if (m_powered)
+			value |= PinVREF::mask;
+	}
+	if (PinTDO::Port::name == port)
+	{
+		value &= ~PinTDO::mask;
+		if (m_powered && m_tdo)
+			value |= PinTDO::mask;
+	}
+	return value;
+}
+
+void TargetModel::risingEdge(bool tms, bool tdi)
+{
+	++m_counters.clocks;
+
+	switch (m_mode)
+	{
+	case Mode::READY:
+		// mode byte MSB first, followed by two more clocks
+		if (m_entryClocks < 8)
+			m_entryByte = (m_entryByte << 1) | tdi;
+
+		if (++m_entryClocks == 10)
+		{
+			if (m_entryByte == 0x96)
+			{
+				m_mode = Mode::ICP;
+				m_frameClocks = 0;
+				m_icpState = ICPState::COMMAND;
+			}
+			else if (m_entryByte == 0xA5)
+			{
+				m_mode = Mode::JTAG;
+				m_tap = TAPState::TEST_LOGIC_RESET;
+			}
+			else
+			{
+				m_mode = Mode::UNKNOWN;
+			}
+		}
+		break;
+
+	case Mode::ICP:
+		// 8 data bits MSB first and one more clock per frame
+		if (m_frameClocks < 8)
+			m_frameByte = (m_frameByte << 1) | tdi;
+
+		if (++m_frameClocks == 9)
+		{
+			m_frameClocks = 0;
+			++m_counters.icpFrames;
+
+			if (m_icpState == ICPState::TRANSMIT)
+			{
+				if (m_txRemaining != 0xFF && --m_txRemaining == 0)
+					m_icpState = ICPState::COMMAND;
+				else
+					m_txByte = icpTransmit();
+			}
+			else
+			{
+				icpReceive(m_frameByte);
+			}
+		}
+		break;
+
+	case Mode::JTAG:
+		if (m_tap == TAPState::SHIFT_DR)
+		{
+			m_drIn = (m_drIn << 1) | tdi;
+			++m_drBits;
+			++m_counters.jtagShifts;
+		}
+		else if (m_tap == TAPState::SHIFT_IR)
+		{
+			m_irShift |= uint8_t(tdi) << m_irBits;
+			++m_irBits;
+			++m_counters.jtagShifts;
+		}
+
+		m_tap = nextTAPState(m_tap, tms);
+
+		switch (m_tap)
+		{
+		case TAPState::TEST_LOGIC_RESET:
+			m_ir = 14;
+			break;
+		case TAPState::CAPTURE_DR:
+			captureDR();
+			break;
+		case TAPState::CAPTURE_IR:
+			m_irShift = 0;
+			m_irBits = 0;
+			break;
+		case TAPState::UPDATE_DR:
+			updateDR();
+			break;
+		case TAPState::UPDATE_IR:
+			m_ir = m_irShift & 0x0F;
+			break;
+		default:
+			break;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void TargetModel::fallingEdge()
+{
+	if (m_mode == Mode::ICP)
+	{
+		// bit n of a transmitted byte (LSB first) is valid after the falling edge of clock n
+		if (m_icpState == ICPState::TRANSMIT && m_frameClocks >= 1 && m_frameClocks <= 8)
+			m_tdo = (m_txByte >> (m_frameClocks - 1)) & 1;
+		else
+			m_tdo = false;
+	}
+	else if (m_mode == Mode::JTAG)
+	{
+		// next DR bit, MSB first, is valid after the falling edge
+		if (m_tap == TAPState::SHIFT_DR && m_drBits < m_drOutBits)
+			m_tdo = (m_drOut >> (m_drOutBits - 1 - m_drBits)) & 1;
+		else
+			m_tdo = false;
+	}
+}
+
+void TargetModel::icpReceive(uint8_t value)
+{
+	if (m_icpState == ICPState::ARGUMENT)
+	{
+		switch (m_icpCommand)
+		{
+		case 0x40:	// ICP_SET_IB_OFFSET_L
+			m_ibOffset = (m_ibOffset & 0xFFFFFF00) | value;
+			break;
+		case 0x41:	// ICP_SET_IB_OFFSET_H
+			m_ibOffset = (m_ibOffset & 0xFFFF00FF) | (uint32_t(value) << 8);
+			break;
+		case 0x4C:	// ICP_SET_XPAGE
+			m_ibOffset = (m_ibOffset & 0x0000FFFF) | (uint32_t(value) << 16);
+			break;
+		default:
+			break;
+		}
+
+		if (--m_icpArguments == 0)
+			m_icpState = ICPState::COMMAND;
+		return;
+	}
+
+	m_icpCommand = value;
+	switch (value)
+	{
+	case 0x40:
+	case 0x41:
+	case 0x49:	// ICP_PING
+	case 0x4C:
+		m_icpArguments = 1;
+		m_icpState = ICPState::ARGUMENT;
+		break;
+	case 0x46:	// sent before reads on all chip types except 1, meaning unknown
+		m_icpArguments = 2;
+		m_icpState = ICPState::ARGUMENT;
+		break;
+	case 0x43:	// ICP_GET_IB_OFFSET
+		m_txRemaining = 2;
+		m_icpState = ICPState::TRANSMIT;
+		m_txByte = m_ibOffset & 0xFF;
+		break;
+	case 0x44:	// ICP_READ_FLASH
+	case 0x4A:	// ICP_READ_CUSTOM_BLOCK
+		m_txRemaining = 0xFF;
+		m_txCustomBlock = (value == 0x4A);
+		m_icpState = ICPState::TRANSMIT;
+		m_txByte = icpTransmit();
+		break;
+	default:
+		break;
+	}
+}
+
+uint8_t TargetModel::icpTransmit()
+{
+	if (m_icpCommand == 0x43)
+		return (m_ibOffset >> 8) & 0xFF;
+
+	uint8_t value = m_txCustomBlock ? readCustomBlock(m_ibOffset) : readFlash(m_ibOffset);
+	++m_ibOffset;
+	return value;
+}
+
+TargetModel::TAPState TargetModel::nextTAPState(TAPState state, bool tms)
+{
+	switch (state)
+	{
+	case TAPState::TEST_LOGIC_RESET: return tms ? TAPState::TEST_LOGIC_RESET : TAPState::RUN_TEST_IDLE;
+	case TAPState::RUN_TEST_IDLE: return tms ? TAPState::SELECT_DR : TAPState::RUN_TEST_IDLE;
+	case TAPState::SELECT_DR: return tms ? TAPState::SELECT_IR : TAPState::CAPTURE_DR;
+	case TAPState::CAPTURE_DR: return tms ? TAPState::EXIT1_DR : TAPState::SHIFT_DR;
+	case TAPState::SHIFT_DR: return tms ? TAPState::EXIT1_DR : TAPState::SHIFT_DR;
+	case TAPState::EXIT1_DR: return tms ? TAPState::UPDATE_DR : TAPState::PAUSE_DR;
+	case TAPState::PAUSE_DR: return tms ? TAPState::EXIT2_DR : TAPState::PAUSE_DR;
+	case TAPState::EXIT2_DR: return tms ? TAPState::UPDATE_DR : TAPState::SHIFT_DR;
+	case TAPState::UPDATE_DR: return tms ? TAPState::SELECT_DR : TAPState::RUN_TEST_IDLE;
+	case TAPState::SELECT_IR: return tms ? TAPState::TEST_LOGIC_RESET : TAPState::CAPTURE_IR;
+	case TAPState::CAPTURE_IR: return tms ? TAPState::EXIT1_IR : TAPState::SHIFT_IR;
+	case TAPState::SHIFT_IR: return tms ? TAPState::EXIT1_IR : TAPState::SHIFT_IR;
+	case TAPState::EXIT1_IR: return tms ? TAPState::UPDATE_IR : TAPState::PAUSE_IR;
+	case TAPState::PAUSE_IR: return tms ? TAPState::EXIT2_IR : TAPState::PAUSE_IR;
+	case TAPState::EXIT2_IR: return tms ? TAPState::UPDATE_IR : TAPState::SHIFT_IR;
+	case TAPState::UPDATE_IR: return tms ? TAPState::SELECT_DR : TAPState::RUN_TEST_IDLE;
+	}
+	return TAPState::TEST_LOGIC_RESET;
+}
+
+void TargetModel::captureDR()
+{
+	m_drIn = 0;
+	m_drBits = 0;
+
+	switch (m_ir)
+	{
+	case 14:	// JTAG_IDCODE
+		m_drOut = m_id;
+		m_drOutBits = 16;
+		break;
+	case 0:
+		// 16 address bits in, 6 control bits, then the byte at the previously shifted address out
+		m_drOut = readFlash(m_jtagAddress);
+		m_drOutBits = 30;
+		break;
+	default:
+		m_drOutBits = 0;
+		break;
+	}
+}
+
+void TargetModel::updateDR()
+{
+	if (m_ir == 0 && m_drBits == 30)
+	{
+		uint32_t address = m_drIn >> 14;
+		if (address & 0x8000 && m_bank > 0)
+			// banks 1-N are mapped to upper half of address space
+			address = uint32_t(m_bank) * 0x8000 + (address & 0x7FFF);
+		m_jtagAddress = address;
+	}
+	else if (m_ir == 12 && m_drBits == 8)
+	{
+		// instructions executed by the core, only MOV PBANK, #bank matters here
+		m_opcodes[0] = m_opcodes[1];
+		m_opcodes[1] = m_opcodes[2];
+		m_opcodes[2] = m_drIn & 0xFF;
+		if (m_opcodes[0] == 0x75 && m_opcodes[1] == 0xB6)
+			m_bank = m_opcodes[2];
+	}
+}
+
+uint8_t TargetModel::readFlash(uint32_t address) const
+{
+	return (address < m_flash.size()) ? m_flash[address] : 0xFF;
+}
+
+uint8_t TargetModel::readCustomBlock(uint32_t address) const
+{
+	return (address < m_customBlock.size()) ? m_customBlock[address] : 0xFF;
+}
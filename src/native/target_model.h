@@ -0,0 +1,139 @@
+/*
+   https://github.com/gashtaan/sinowealth-8051-dumper
+
+   Copyright (C) 2023, Michal Kovacik
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License version 3, as
+   published by the Free Software Foundation.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Bit-level software model of a SinoWealth 8051 target, driven by the
+// pin levels the JTAG driver writes. It implements mode entry, the ICP
+// command set, the JTAG TAP with IDCODE and the address-shift flash read.
+class TargetModel
+{
+public:
+	struct Counters
+	{
+		uint32_t clocks;		// TCK rising edges
+		uint32_t icpFrames;		// 9-clock ICP frames
+		uint32_t jtagShifts;	// TCK edges in Shift-DR/Shift-IR
+		double delayUs;			// sum of _delay_us() calls
+	};
+
+	TargetModel();
+
+	void load(const std::vector<uint8_t>& flash, const std::vector<uint8_t>& customBlock, uint16_t id);
+
+	// power loss resets the target, it waits for the connect sequence again
+	void setPowered(bool powered);
+
+	// ports are named 'B'..'D' like the AVR ones
+	void writePort(char port, uint8_t value);
+	void writeDirection(char port, uint8_t value) { m_directions[port - 'B'] = value; }
+	uint8_t readPins(char port, uint8_t value) const;
+	void delay(double us) { m_counters.delayUs += us; }
+
+	// any of TCK, TMS and TDI configured as output
+	bool driven() const;
+
+	const Counters& counters() const { return m_counters; }
+	void resetCounters() { m_counters = Counters(); }
+
+private:
+	enum class Mode
+	{
+		OFF,	// powered up, waiting for the first reset edge
+		READY,	// receiving the mode byte
+		ICP,
+		JTAG,
+		UNKNOWN
+	};
+
+	enum class TAPState
+	{
+		TEST_LOGIC_RESET, RUN_TEST_IDLE,
+		SELECT_DR, CAPTURE_DR, SHIFT_DR, EXIT1_DR, PAUSE_DR, EXIT2_DR, UPDATE_DR,
+		SELECT_IR, CAPTURE_IR, SHIFT_IR, EXIT1_IR, PAUSE_IR, EXIT2_IR, UPDATE_IR
+	};
+
+	template <class P>
+	bool level() const;
+	template <class P>
+	bool isOutput() const;
+
+	void risingEdge(bool tms, bool tdi);
+	void fallingEdge();
+
+	void icpReceive(uint8_t value);
+	uint8_t icpTransmit();
+
+	static TAPState nextTAPState(TAPState state, bool tms);
+	void captureDR();
+	void updateDR();
+
+	uint8_t readFlash(uint32_t address) const;
+	uint8_t readCustomBlock(uint32_t address) const;
+
+	std::vector<uint8_t> m_flash;
+	std::vector<uint8_t> m_customBlock;
+	uint16_t m_id = 0;
+	bool m_powered = true;
+
+	uint8_t m_ports[3] = {};
+	uint8_t m_directions[3] = {};
+	bool m_tck = false;
+	bool m_tms = false;
+	bool m_tdo = false;
+	Mode m_mode = Mode::OFF;
+	Counters m_counters = {};
+
+	// mode entry
+	uint8_t m_entryClocks = 0;
+	uint8_t m_entryByte = 0;
+
+	// ICP
+	enum class ICPState
+	{
+		COMMAND,
+		ARGUMENT,
+		TRANSMIT
+	};
+
+	uint8_t m_frameClocks = 0;
+	uint8_t m_frameByte = 0;
+	ICPState m_icpState = ICPState::COMMAND;
+	uint8_t m_icpCommand = 0;
+	uint8_t m_icpArguments = 0;
+	uint8_t m_txByte = 0;
+	uint8_t m_txRemaining = 0;	// 0xFF streams until reset
+	bool m_txCustomBlock = false;
+	uint32_t m_ibOffset = 0;
+
+	// JTAG
+	TAPState m_tap = TAPState::TEST_LOGIC_RESET;
+	uint8_t m_ir = 0;
+	uint8_t m_irShift = 0;
+	uint8_t m_irBits = 0;
+	uint32_t m_drIn = 0;
+	uint8_t m_drBits = 0;
+	uint32_t m_drOut = 0;	// MSB of m_drOutBits first
+	uint8_t m_drOutBits = 0;
+	uint32_t m_jtagAddress = 0;
+	uint8_t m_bank = 0;
+	uint8_t m_opcodes[3] = {};
+};
+
+TargetModel& targetModel();
@@ -42,6 +42,19 @@ void rpc_disconnect() {
     }
 }
 
+void rpc_release() {
+    if (jtag) {
+        jtag->release();
+    }
+}
+
+bool rpc_getVREF() {
+    if (!jtag) {
+        jtag = new JTAG();
+    }
+    return jtag->checkVREF();
+}
+
 bool rpc_checkICP() {
     if (!jtag) {
         return false;
@@ -138,6 +151,39 @@ unsigned char rpc_detectReadMethod() {
     return 0;  // Neither method works or flash is blank
 }
 
+static uint16_t crc16Update(uint16_t crc, uint8_t data) {
+    // CRC-16/CCITT-FALSE (poly 0x1021), same as Python's binascii.crc_hqx
+    crc ^= (uint16_t)data << 8;
+    for (uint8_t n = 0; n < 8; ++n) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+bool rpc_crcFlash(unsigned long address, unsigned long length, unsigned char method, bool customBlock) {
+    if (!jtag) {
+        return false;
+    }
+
+    JTAG::readFlashMethod readFlash = (method == 2) ? &JTAG::readFlashJTAG : &JTAG::readFlashICP;
+
+    uint16_t crc = 0xFFFF;
+    while (length > 0) {
+        uint8_t chunk = (length > 128) ? 128 : length;
+        if (!(jtag->*readFlash)(buffer, chunk, address, customBlock)) {
+            return false;
+        }
+        for (uint8_t n = 0; n < chunk; ++n) {
+            crc = crc16Update(crc, buffer[n]);
+        }
+        address += chunk;
+        length -= chunk;
+    }
+    buffer[0] = crc & 0xFF;
+    buffer[1] = crc >> 8;
+    return true;
+}
+
 unsigned int rpc_getProductBlockAddress() {
     switch (CHIP_CUSTOM_BLOCK) {
         case 2:
@@ -237,6 +283,8 @@ void rpc_loop() {
         Serial,
         rpc_connect, F("connect: Connect to target device. @return: Success status."),
         rpc_disconnect, F("disconnect: Disconnect from target device."),
+        rpc_release, F("release: Put all JTAG pins to Hi-Z."),
+        rpc_getVREF, F("getVREF: Check if target is powered. @return: VREF level."),
         rpc_checkICP, F("checkICP: Check if ICP mode is working. @return: True if successful."),
         rpc_checkJTAG, F("checkJTAG: Check if JTAG mode is working. @return: True if successful."),
         rpc_getID, F("getID: Get JTAG ID code. @return: 16-bit ID code."),
@@ -247,6 +295,7 @@ void rpc_loop() {
         rpc_read16JTAG, F("read16JTAG: Read 16 bytes via JTAG. @address: Addr. @customBlock: Flag. @return: OK."),
         rpc_getBufferByte, F("getBufferByte: Get byte from buffer. @index: Index. @return: Byte."),
         rpc_detectReadMethod, F("detectReadMethod: Auto-detect read method. @return: 0=fail, 1=ICP, 2=JTAG."),
+        rpc_crcFlash, F("crcFlash: CRC-16 of flash range. @address: Addr. @length: Len. @method: 1=ICP, 2=JTAG. @customBlock: Flag. @return: Success, CRC in buffer[0..1]."),
         rpc_getProductBlockAddress, F("getProductBlockAddress: Get product block address. @return: Address."),
         rpc_getCodeOptionsAddress, F("getCodeOptionsAddress: Get code options address. @return: Address."),
         rpc_getCodeOptionsSize, F("getCodeOptionsSize: Get code options size. @return: Size."),